@@ -0,0 +1,104 @@
+﻿#include "appconfig.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+
+QString AppConfig::resultFilePath() const {
+    return dataDir + "/result.txt";
+}
+
+QString AppConfig::resultFolderPath() const {
+    return dataDir + "/resultfile";
+}
+
+QString AppConfig::imageFolderPath() const {
+    return dataDir + "/images";
+}
+
+namespace {
+QString settingsPath() {
+    QString iniPath = qEnvironmentVariable("QUICKDRAW_CONFIG");
+    if (iniPath.isEmpty()) {
+        iniPath = QCoreApplication::applicationDirPath() + "/quickdraw.ini";
+    }
+    return iniPath;
+}
+}
+
+AppConfig AppConfig::load() {
+    QSettings settings(settingsPath(), QSettings::IniFormat);
+
+    AppConfig config;
+    config.dataDir = settings.value("paths/dataDir",
+                                    "C:/Users/jason/Desktop/py_quickDraw_ndjson2img/py_quickDraw_ndjson2img").toString();
+    config.modelPath = settings.value("paths/model", config.dataDir + "/model_unquant.tflite").toString();
+    config.labelsPath = settings.value("paths/labels", config.dataDir + "/labels.txt").toString();
+    config.grayscaleCanvas = settings.value("canvas/grayscale", config.grayscaleCanvas).toBool();
+    // 歸檔與錄製都只增不減，預設關閉，需要時在設定檔指定資料夾（例如 dataDir/history、dataDir/recordings）
+    config.historyDir = settings.value("paths/history").toString();
+    config.recordingsDir = settings.value("paths/recordings").toString();
+    config.classifierBackend = settings.value("classifier/backend", config.classifierBackend).toString().toLower();
+    config.inferenceServer = settings.value("inference/server").toString();
+    config.inferenceTimeoutMs = qMax(0, settings.value("inference/timeoutMs", config.inferenceTimeoutMs).toInt());
+    config.serverMaxBatch = qMax(1, settings.value("server/maxBatch", config.serverMaxBatch).toInt());
+    config.serverMaxWaitMs = qMax(0, settings.value("server/maxWaitMs", config.serverMaxWaitMs).toInt());
+    config.cacheCapacity = qMax(0, settings.value("cache/capacity", config.cacheCapacity).toInt());
+    config.cacheMaxDistance = qBound(0, settings.value("cache/maxDistance", config.cacheMaxDistance).toInt(), 64);
+    config.warmupRuns = qMax(0, settings.value("model/warmupRuns", config.warmupRuns).toInt());
+    config.inferenceThreads = qMax(0, settings.value("model/threads", config.inferenceThreads).toInt());
+    const QString delegate = settings.value("model/delegate", config.inferenceDelegate).toString().toLower();
+    if (delegate == "auto" || delegate == "xnnpack" || delegate == "none") {
+        config.inferenceDelegate = delegate;
+    } else {
+        qWarning().noquote() << "model/delegate 的值無效（可用 auto、xnnpack、none），改用 auto：" + delegate;
+    }
+    config.watchModel = settings.value("model/watch", config.watchModel).toBool();
+    config.mockLatencyMs = qMax(0, settings.value("mock/latencyMs", config.mockLatencyMs).toInt());
+    config.mockJitterMs = qMax(0, settings.value("mock/jitterMs", config.mockJitterMs).toInt());
+    config.mockAccuracy = qBound(0.0, settings.value("mock/accuracy", config.mockAccuracy).toDouble(), 1.0);
+    config.resultPollDelayMs = qMax(0, settings.value("results/pollDelayMs", config.resultPollDelayMs).toInt());
+    config.resultPollIntervalMs = qMax(1, settings.value("results/pollIntervalMs", config.resultPollIntervalMs).toInt());
+    config.resultTimeoutMs = qMax(0, settings.value("results/timeoutMs", config.resultTimeoutMs).toInt());
+    config.earlyFinishConfidence = qBound(0.0, settings.value("game/earlyFinishConfidence",
+                                                              config.earlyFinishConfidence).toDouble(), 1.0);
+    config.earlyFinishStreak = qMax(1, settings.value("game/earlyFinishStreak", config.earlyFinishStreak).toInt());
+    config.previewIntervalMs = qMax(100, settings.value("game/previewIntervalMs", config.previewIntervalMs).toInt());
+    config.resultDisplayMs = qMax(0, settings.value("game/resultDisplayMs", config.resultDisplayMs).toInt());
+    config.latencyLogEvery = settings.value("stats/latencyLogEvery", config.latencyLogEvery).toInt();
+    return config;
+}
+
+QString AppConfig::tuningCachePath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/tuning.ini";
+}
+
+AppConfig::EngineTuning AppConfig::loadTuning() {
+    QSettings settings(tuningCachePath(), QSettings::IniFormat);
+    EngineTuning tuning;
+    tuning.signature = settings.value("tuning/signature").toString();
+    tuning.mode = settings.value("tuning/mode").toString();
+    tuning.threads = qMax(1, settings.value("tuning/threads", tuning.threads).toInt());
+    tuning.xnnpack = settings.value("tuning/xnnpack", tuning.xnnpack).toBool();
+    tuning.medianMs = settings.value("tuning/medianMs").toDouble();
+    return tuning;
+}
+
+bool AppConfig::saveTuning(const EngineTuning &tuning) {
+    const QString path = tuningCachePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSettings settings(path, QSettings::IniFormat);
+    settings.setValue("tuning/signature", tuning.signature);
+    settings.setValue("tuning/mode", tuning.mode);
+    settings.setValue("tuning/threads", tuning.threads);
+    settings.setValue("tuning/xnnpack", tuning.xnnpack);
+    settings.setValue("tuning/medianMs", tuning.medianMs);
+    settings.sync();
+    if (settings.status() != QSettings::NoError) {
+        qWarning().noquote() << "無法寫入推理調校結果，下次啟動會重新調校：" + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+﻿#ifndef APPCONFIG_H
+#define APPCONFIG_H
+
+#include <QString>
+
+// 應用程式設定
+// 預設值對應原本寫死的路徑，可由執行檔旁的 quickdraw.ini（或環境變數 QUICKDRAW_CONFIG 指定的檔案）覆寫
+struct AppConfig {
+    QString dataDir;                  // 與 Python 辨識端共用的資料夾
+    QString modelPath;                // TFLite 模型
+    QString labelsPath;               // 類別標籤
+    bool grayscaleCanvas = false;     // 畫布以 8 位元灰階儲存與匯出，畫上彩色時自動轉為彩色（選用，重繪時需轉換格式）
+    QString historyDir;               // 每局結束時歸檔作品與結果，供歷史瀏覽（空字串 = 不歸檔，預設）
+    QString recordingsDir;            // 每題的筆畫錄製，一天一個 .qdsr 檔（空字串 = 不錄製，預設）
+    QString classifierBackend = "auto";  // 辨識後端：auto、tflite、server、fileshare 或 mock（見 Classifier）
+    QString inferenceServer;          // 非空時連線到此名稱的辨識伺服器，而不在本機載入模型
+    int inferenceTimeoutMs = 15000;   // 辨識伺服器：請求等待回覆的上限，逾時視為伺服器故障而改用備援後端重送（0 = 不限）
+    int serverMaxBatch = 8;           // 伺服器模式：一批最多幾張
+    int serverMaxWaitMs = 4;          // 伺服器模式：湊批次時最早的請求最多等多久
+    int cacheCapacity = 256;          // 辨識結果快取的項目數（0 = 停用）
+    int cacheMaxDistance = 3;         // 視為同一張畫布的最大 dHash Hamming 距離
+    int warmupRuns = 3;               // 啟動時的暖機推理次數
+    int inferenceThreads = 0;         // 推理執行緒數（0 = 自動調校）
+    QString inferenceDelegate = "auto";  // CPU 加速：auto（自動調校）、xnnpack 或 none；其他值警告後視為 auto
+    bool watchModel = true;           // 模型或標籤檔更新時自動換用新模型
+    int mockLatencyMs = 20;           // mock 後端：每次辨識的延遲
+    int mockJitterMs = 0;             // mock 後端：依影像額外增加的延遲上限
+    double mockAccuracy = 0.8;        // mock 後端：回答題目本身的比例
+    int resultPollDelayMs = 10000;    // Python 流程：提交後多久開始檢查 result.txt
+    int resultPollIntervalMs = 1000;  // Python 流程：檢查 result.txt 的間隔
+    int resultTimeoutMs = 30000;      // Python 流程：開始檢查後最多等多久，逾時視為辨識失敗（0 = 不限）
+    double earlyFinishConfidence = 0.0;  // 作畫時背景辨識，題目類別的信心度連續達到此值就提前答對（0 = 停用）
+    int earlyFinishStreak = 2;        // 需要連續幾次達標（每次評估都要有新筆畫）
+    int previewIntervalMs = 1000;     // 背景辨識的間隔
+    int resultDisplayMs = 1500;       // 顯示對錯後停留多久才進入下一題
+    int latencyLogEvery = 6;          // 每幾次提交輸出一行延遲統計（0 = 不輸出）
+
+    QString resultFilePath() const;
+    QString resultFolderPath() const;
+    QString imageFolderPath() const;
+
+    static AppConfig load();
+
+    // 自動調校的結果，存在應用程式資料夾的 tuning.ini（見 tuningCachePath），不動 quickdraw.ini：
+    // 操作人員寫的註解不會被 QSettings 洗掉，程式資料夾唯讀時也能保存
+    struct EngineTuning {
+        QString signature;            // 調校時的模型與機器指紋，見 InferenceTuner::signature
+        QString mode;                 // 調校了哪些項目，設定改變時需重新調校
+        int threads = 1;
+        bool xnnpack = false;
+        double medianMs = 0.0;
+    };
+    static QString tuningCachePath();
+    static EngineTuning loadTuning();
+    static bool saveTuning(const EngineTuning &tuning);   // 無法寫入時回傳 false，下次啟動會重新調校
+};
+
+#endif // APPCONFIG_H
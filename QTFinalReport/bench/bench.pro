@@ -0,0 +1,9 @@
+# 基準測試程式（與主程式分開建置）
+# 建置：qmake bench.pro && make，執行方式見各子專案 main.cpp 開頭說明
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    canvasbench \
+    inferencebench \
+    soak
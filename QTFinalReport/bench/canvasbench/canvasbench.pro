@@ -0,0 +1,19 @@
+# 畫布繪圖基準測試
+# 以 QT_QPA_PLATFORM=offscreen 執行，不需要顯示器
+
+QT += core gui widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = canvasbench
+
+INCLUDEPATH += $$PWD/../common
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    $$PWD/../common/benchstats.h
+
+include(../../canvas.pri)
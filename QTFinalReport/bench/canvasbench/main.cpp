@@ -0,0 +1,371 @@
+﻿// 畫布繪圖基準測試
+//
+// 將合成或錄製的滑鼠事件直接送進 Canvas，量測：
+//   - 每秒事件數
+//   - 每個事件與每次重繪的延遲百分位數（微秒）
+//   - 配置次數與位元組數
+//   - 最後畫面的 PNG 大小（--grayscale 比較 8 位元灰階畫布）
+//   - --model-size 224：每筆同時畫進模型解析度緩衝的額外成本，對照事後整張縮放的時間
+// 結果以 JSON 輸出，方便與基準線比較
+//
+// 用法：
+//   QT_QPA_PLATFORM=offscreen ./canvasbench [--scenario scribble|strokes|all]
+//       [--replay events.txt] [--brush 30] [--events-per-frame 4] [--seed 1] [--grayscale] [--model-size 224]
+//       [--output result.json]
+//
+// 錄製檔為文字格式，每行「press|move|release x y」，# 開頭為註解；
+// 也可直接使用遊戲錄下的 .qdsr 筆畫檔（逐筆送出，不依原本的時間間隔）
+
+#include "benchstats.h"
+#include "canvas.h"
+#include "strokerecording.h"
+#include <QApplication>
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+// ---- 配置計數 ----
+// glibc 上攔截 malloc 家族（Qt 容器直接使用 malloc），其他平台只攔截 operator new
+namespace {
+std::atomic<quint64> allocationCount{0};
+std::atomic<quint64> allocationBytes{0};
+
+inline void countAllocation(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+}
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(std::size_t size) {
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) {
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, std::size_t size) {
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+}
+static const char *allocatorName = "malloc";
+#else
+void *operator new(std::size_t size) {
+    countAllocation(size);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+static const char *allocatorName = "operator-new";
+#endif
+
+// ---- 事件串流 ----
+constexpr double Pi = 3.14159265358979323846;
+
+struct InputEvent {
+    QEvent::Type type;
+    QPointF pos;
+};
+
+using EventStream = QVector<InputEvent>;
+
+static void appendStroke(EventStream &stream, const QVector<QPointF> &points) {
+    if (points.isEmpty()) {
+        return;
+    }
+    stream.append({QEvent::MouseButtonPress, points.first()});
+    for (int i = 1; i < points.size(); ++i) {
+        stream.append({QEvent::MouseMove, points[i]});
+    }
+    stream.append({QEvent::MouseButtonRelease, points.last()});
+}
+
+// 快速塗鴉：大量短筆畫，每步跳動大
+static EventStream scribbleStream(std::mt19937 &rng, const QSize &size) {
+    std::uniform_real_distribution<double> x(0, size.width() - 1);
+    std::uniform_real_distribution<double> y(0, size.height() - 1);
+    std::uniform_real_distribution<double> step(-80, 80);
+    EventStream stream;
+    for (int stroke = 0; stroke < 200; ++stroke) {
+        QVector<QPointF> points;
+        QPointF p(x(rng), y(rng));
+        for (int i = 0; i < 40; ++i) {
+            points.append(p);
+            p = QPointF(qBound(0.0, p.x() + step(rng), size.width() - 1.0),
+                        qBound(0.0, p.y() + step(rng), size.height() - 1.0));
+        }
+        appendStroke(stream, points);
+    }
+    return stream;
+}
+
+// 長筆畫：少量連續曲線，每步約 2 像素
+static EventStream longStrokeStream(std::mt19937 &rng, const QSize &size) {
+    std::uniform_real_distribution<double> phase(0, 2 * Pi);
+    EventStream stream;
+    const QPointF center(size.width() / 2.0, size.height() / 2.0);
+    for (int stroke = 0; stroke < 8; ++stroke) {
+        const double a = phase(rng);
+        QVector<QPointF> points;
+        for (int i = 0; i < 1500; ++i) {
+            const double t = i / 1500.0 * 2 * Pi;
+            points.append(center + QPointF(std::sin(3 * t + a) * size.width() * 0.45,
+                                           std::sin(2 * t) * size.height() * 0.45));
+        }
+        appendStroke(stream, points);
+    }
+    return stream;
+}
+
+static bool loadRecordedStream(const QString &path, EventStream &stream, QString *error) {
+    if (path.endsWith(".qdsr", Qt::CaseInsensitive)) {
+        const QVector<StrokeRecording> recordings = StrokeRecording::readAll(path, error);
+        for (const StrokeRecording &recording : recordings) {
+            for (const StrokeRecording::Stroke &stroke : recording.strokes) {
+                QVector<QPointF> points;
+                for (const StrokeRecording::Point &point : stroke.points) {
+                    points.append(point.pos);
+                }
+                appendStroke(stream, points);
+            }
+        }
+        if (stream.isEmpty() && error->isEmpty()) {
+            *error = "錄製檔沒有筆畫：" + path;
+        }
+        return !stream.isEmpty();
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = "無法開啟錄製檔：" + path;
+        return false;
+    }
+    QTextStream in(&file);
+    int lineNumber = 0;
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+        QEvent::Type type;
+        if (parts.value(0) == "press") {
+            type = QEvent::MouseButtonPress;
+        } else if (parts.value(0) == "move") {
+            type = QEvent::MouseMove;
+        } else if (parts.value(0) == "release") {
+            type = QEvent::MouseButtonRelease;
+        } else {
+            *error = QString("錄製檔第 %1 行格式錯誤").arg(lineNumber);
+            return false;
+        }
+        stream.append({type, QPointF(parts.value(1).toDouble(), parts.value(2).toDouble())});
+    }
+    return true;
+}
+
+// ---- 量測 ----
+static QJsonObject runScenario(const QString &name, const EventStream &stream, int brushSize, int eventsPerFrame,
+                               bool grayscale, int modelSize) {
+    Canvas canvas;
+    canvas.setGrayscale(grayscale);
+    canvas.setModelInputSize(modelSize);
+    canvas.setBrushSize(brushSize);
+    canvas.show();
+    QCoreApplication::processEvents();
+
+    QVector<double> eventLatency;
+    QVector<double> paintLatency;
+    eventLatency.reserve(stream.size());
+    paintLatency.reserve(stream.size() / qMax(1, eventsPerFrame) + 1);
+
+    const quint64 allocCountBefore = allocationCount.load();
+    const quint64 allocBytesBefore = allocationBytes.load();
+    QElapsedTimer total;
+    QElapsedTimer timer;
+    qint64 busyNs = 0;
+    total.start();
+
+    int pendingEvents = 0;
+    for (const InputEvent &input : stream) {
+        const bool pressed = input.type != QEvent::MouseButtonRelease;
+        const Qt::MouseButton button = input.type == QEvent::MouseMove ? Qt::NoButton : Qt::LeftButton;
+        QMouseEvent event(input.type, input.pos, canvas.mapToGlobal(input.pos), button,
+                          pressed ? Qt::LeftButton : Qt::NoButton, Qt::NoModifier);
+
+        timer.start();
+        QCoreApplication::sendEvent(&canvas, &event);
+        const qint64 eventNs = timer.nsecsElapsed();
+        eventLatency.append(eventNs / 1000.0);
+        busyNs += eventNs;
+
+        // 模擬每個畫面合併 eventsPerFrame 個輸入事件
+        if (++pendingEvents >= eventsPerFrame) {
+            timer.start();
+            canvas.repaint();
+            const qint64 paintNs = timer.nsecsElapsed();
+            paintLatency.append(paintNs / 1000.0);
+            busyNs += paintNs;
+            pendingEvents = 0;
+            QCoreApplication::processEvents();  // 清掉 update() 排入的事件，不計時
+        }
+    }
+    const qint64 wallNs = total.nsecsElapsed();
+    const quint64 allocCount = allocationCount.load() - allocCountBefore;
+    const quint64 allocBytes = allocationBytes.load() - allocBytesBefore;
+
+    QJsonObject allocations;
+    allocations["allocator"] = allocatorName;
+    allocations["count"] = double(allocCount);
+    allocations["bytes"] = double(allocBytes);
+    allocations["perEvent"] = stream.isEmpty() ? 0.0 : double(allocCount) / stream.size();
+
+    // 提交時的 PNG 編碼（不列入上面的配置統計）
+    QByteArray png;
+    QBuffer buffer(&png);
+    QElapsedTimer encodeTimer;
+    encodeTimer.start();
+    buffer.open(QIODevice::WriteOnly);
+    canvas.image().save(&buffer, "PNG");
+    const double encodeMs = encodeTimer.nsecsElapsed() / 1e6;
+
+    // 沒有模型緩衝時每次辨識都要做的事：置中裁切後平滑縮放整張畫布（與 InferenceEngine::preprocess 相同）
+    const QImage surface = canvas.image();
+    const int side = qMin(surface.width(), surface.height());
+    QElapsedTimer downscaleTimer;
+    downscaleTimer.start();
+    const QImage downscaled = surface.copy((surface.width() - side) / 2, (surface.height() - side) / 2, side, side)
+                                  .scaled(224, 224, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    const double downscaleUs = downscaleTimer.nsecsElapsed() / 1e3;
+
+    QJsonObject result;
+    result["name"] = name;
+    result["grayscale"] = canvas.isGrayscale();
+    result["canvasBytes"] = double(canvas.image().sizeInBytes());
+    result["pngBytes"] = int(png.size());
+    result["encodeMs"] = encodeMs;
+    result["modelSize"] = modelSize;
+    result["downscaleUs"] = downscaled.isNull() ? 0.0 : downscaleUs;
+    result["events"] = int(stream.size());
+    result["frames"] = int(paintLatency.size());
+    result["brushSize"] = brushSize;
+    result["eventsPerFrame"] = eventsPerFrame;
+    result["eventsPerSec"] = busyNs > 0 ? stream.size() * 1e9 / busyNs : 0.0;
+    result["wallMs"] = wallNs / 1e6;
+    result["eventLatencyUs"] = BenchStats::summarize(eventLatency);
+    result["paintLatencyUs"] = BenchStats::summarize(paintLatency);
+    result["allocations"] = allocations;
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("canvasbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Canvas 繪圖基準測試");
+    parser.addHelpOption();
+    parser.addOption({"scenario", "合成情境：scribble、strokes 或 all", "name", "all"});
+    parser.addOption({"replay", "改用錄製的事件檔", "file"});
+    parser.addOption({"brush", "筆刷粗細（滑塊上限為 30）", "size", "30"});
+    parser.addOption({"events-per-frame", "每次重繪前合併的事件數", "count", "4"});
+    parser.addOption({"seed", "合成事件的亂數種子", "seed", "1"});
+    parser.addOption({"grayscale", "以 8 位元灰階畫布作畫"});
+    parser.addOption({"model-size", "同時畫進的模型解析度緩衝邊長（0 = 停用）", "side", "0"});
+    parser.addOption({"output", "JSON 輸出檔（預設輸出到 stdout）", "file"});
+    parser.process(app);
+
+    const int brushSize = parser.value("brush").toInt();
+    const int eventsPerFrame = qMax(1, parser.value("events-per-frame").toInt());
+    std::mt19937 rng(parser.value("seed").toUInt());
+    const QSize canvasSize = Canvas().size();
+
+    QVector<QPair<QString, EventStream>> scenarios;
+    if (parser.isSet("replay")) {
+        EventStream stream;
+        QString error;
+        if (!loadRecordedStream(parser.value("replay"), stream, &error)) {
+            qCritical().noquote() << error;
+            return 1;
+        }
+        scenarios.append({"replay", stream});
+    } else {
+        const QString scenario = parser.value("scenario");
+        if (scenario == "scribble" || scenario == "all") {
+            scenarios.append({"scribble", scribbleStream(rng, canvasSize)});
+        }
+        if (scenario == "strokes" || scenario == "all") {
+            scenarios.append({"strokes", longStrokeStream(rng, canvasSize)});
+        }
+        if (scenarios.isEmpty()) {
+            qCritical().noquote() << "未知的情境：" + scenario;
+            return 1;
+        }
+    }
+
+    QJsonArray results;
+    for (const auto &scenario : scenarios) {
+        const QJsonObject result = runScenario(scenario.first, scenario.second, brushSize, eventsPerFrame,
+                                               parser.isSet("grayscale"), parser.value("model-size").toInt());
+        results.append(result);
+        qInfo().noquote() << QString("%1: %2 events/s, event p99 %3 us, paint p99 %4 us")
+                                 .arg(scenario.first)
+                                 .arg(result["eventsPerSec"].toDouble(), 0, 'f', 0)
+                                 .arg(result["eventLatencyUs"].toObject()["p99"].toDouble(), 0, 'f', 1)
+                                 .arg(result["paintLatencyUs"].toObject()["p99"].toDouble(), 0, 'f', 1);
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "canvas";
+    report["qtVersion"] = qVersion();
+    report["platform"] = QGuiApplication::platformName();
+    report["scenarios"] = results;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet("output")) {
+        QFile out(parser.value("output"));
+        if (!out.open(QIODevice::WriteOnly)) {
+            qCritical().noquote() << "無法寫入輸出檔：" + parser.value("output");
+            return 1;
+        }
+        out.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
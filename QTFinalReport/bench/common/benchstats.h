@@ -0,0 +1,39 @@
+﻿#ifndef BENCHSTATS_H
+#define BENCHSTATS_H
+
+#include <QJsonObject>
+#include <QVector>
+#include <algorithm>
+
+// 基準測試共用的統計工具：延遲樣本以微秒記錄，輸出百分位數
+namespace BenchStats {
+
+inline double percentile(QVector<double> samples, double p) {
+    if (samples.isEmpty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const double rank = p / 100.0 * (samples.size() - 1);
+    const int lower = int(rank);
+    const int upper = qMin(lower + 1, int(samples.size()) - 1);
+    return samples[lower] + (samples[upper] - samples[lower]) * (rank - lower);
+}
+
+inline QJsonObject summarize(const QVector<double> &samples) {
+    double sum = 0.0;
+    for (double value : samples) {
+        sum += value;
+    }
+    QJsonObject summary;
+    summary["count"] = int(samples.size());
+    summary["mean"] = samples.isEmpty() ? 0.0 : sum / samples.size();
+    summary["p50"] = percentile(samples, 50);
+    summary["p90"] = percentile(samples, 90);
+    summary["p99"] = percentile(samples, 99);
+    summary["max"] = samples.isEmpty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+    return summary;
+}
+
+} // namespace BenchStats
+
+#endif // BENCHSTATS_H
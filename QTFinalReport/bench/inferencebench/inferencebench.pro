@@ -0,0 +1,19 @@
+# 模型推理基準測試
+# 需以 TFLite 編譯：qmake "TFLITE_DIR=C:/libs/tflite" inferencebench.pro
+
+QT += core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = inferencebench
+
+INCLUDEPATH += $$PWD/../common
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    $$PWD/../common/benchstats.h
+
+include(../../inference.pri)
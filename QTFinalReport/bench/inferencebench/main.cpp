@@ -0,0 +1,239 @@
+﻿// 模型推理基準測試
+//
+// 分別量測模型載入、前處理、invoke 與後處理（argmax / top-k），
+// 並在不同執行緒數、CPU delegate 與批次大小下重複執行，輸出吞吐量與延遲百分位數（JSON）
+//
+// 用法：
+//   ./inferencebench --model model_unquant.tflite --labels labels.txt
+//       [--threads 1,2,4] [--delegates none,xnnpack] [--batch 1,4,8] [--warmup 5] [--repeat 50]
+//       [--images dir] [--grayscale] [--output result.json]
+//
+// --grayscale 把輸入轉成 8 位元灰階，量測遊戲單色畫布的前處理路徑
+
+#include "benchstats.h"
+#include "inferenceengine.h"
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPainter>
+#include <QTextStream>
+#include <random>
+
+static QVector<int> parseList(const QString &text) {
+    QVector<int> values;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        const int value = part.trimmed().toInt();
+        if (value > 0) {
+            values.append(value);
+        }
+    }
+    return values;
+}
+
+// 產生類似玩家作品的 900x600 塗鴉
+static QVector<QImage> syntheticDrawings(int count) {
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> x(0, 899);
+    std::uniform_int_distribution<int> y(0, 599);
+    QVector<QImage> images;
+    for (int i = 0; i < count; ++i) {
+        QImage image(900, 600, QImage::Format_RGB32);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        painter.setPen(QPen(Qt::black, 5, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        QPoint last(x(rng), y(rng));
+        for (int segment = 0; segment < 60; ++segment) {
+            const QPoint next(x(rng), y(rng));
+            painter.drawLine(last, next);
+            last = next;
+        }
+        images.append(image);
+    }
+    return images;
+}
+
+static QVector<QImage> loadImages(const QString &directory) {
+    QVector<QImage> images;
+    QDirIterator it(directory, {"*.png", "*.jpg", "*.jpeg"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QImage image(it.next());
+        if (!image.isNull()) {
+            images.append(image);
+        }
+    }
+    return images;
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("inferencebench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TFLite 推理基準測試");
+    parser.addHelpOption();
+    parser.addOption({"model", "TFLite 模型", "file", "model_unquant.tflite"});
+    parser.addOption({"labels", "標籤檔", "file", "labels.txt"});
+    parser.addOption({"threads", "要測試的執行緒數（逗號分隔）", "list", "1,2,4"});
+    parser.addOption({"delegates", "要測試的 CPU delegate：none、xnnpack（逗號分隔）", "list",
+                      InferenceEngine::hasXnnpack() ? "none,xnnpack" : "none"});
+    parser.addOption({"batch", "要測試的批次大小（逗號分隔）", "list", "1,4,8"});
+    parser.addOption({"warmup", "每組設定的暖機次數", "count", "5"});
+    parser.addOption({"repeat", "每組設定的量測次數", "count", "50"});
+    parser.addOption({"images", "使用資料夾中的圖片（預設為合成塗鴉）", "dir"});
+    parser.addOption({"grayscale", "以 8 位元灰階輸入（與遊戲的單色畫布相同）"});
+    parser.addOption({"output", "JSON 輸出檔（預設輸出到 stdout）", "file"});
+    parser.process(app);
+
+    const QVector<int> threadCounts = parseList(parser.value("threads"));
+    const QVector<int> batchSizes = parseList(parser.value("batch"));
+    const int warmup = qMax(0, parser.value("warmup").toInt());
+    const int repeat = qMax(1, parser.value("repeat").toInt());
+    if (threadCounts.isEmpty() || batchSizes.isEmpty()) {
+        qCritical() << "--threads 與 --batch 需要至少一個正整數";
+        return 1;
+    }
+    QVector<bool> delegates;
+    for (const QString &name : parser.value("delegates").split(',', Qt::SkipEmptyParts)) {
+        if (name.trimmed() != "none" && name.trimmed() != "xnnpack") {
+            qCritical().noquote() << "未知的 delegate：" + name;
+            return 1;
+        }
+        delegates.append(name.trimmed() == "xnnpack");
+    }
+    if (delegates.isEmpty()) {
+        delegates.append(false);
+    }
+
+    QVector<QImage> images = parser.isSet("images") ? loadImages(parser.value("images")) : syntheticDrawings(32);
+    if (images.isEmpty()) {
+        qCritical().noquote() << "找不到圖片：" + parser.value("images");
+        return 1;
+    }
+    if (parser.isSet("grayscale")) {
+        for (QImage &image : images) {
+            image = image.convertToFormat(QImage::Format_Grayscale8);
+        }
+    }
+
+    QJsonArray runs;
+    for (int setting = 0; setting < threadCounts.size() * delegates.size(); ++setting) {
+        const int threads = threadCounts[setting / delegates.size()];
+        const bool xnnpack = delegates[setting % delegates.size()];
+        InferenceEngine engine;
+        InferenceEngine::Options options;
+        options.numThreads = threads;
+        options.xnnpack = xnnpack;
+
+        QElapsedTimer timer;
+        timer.start();
+        if (!engine.load(parser.value("model"), parser.value("labels"), options)) {
+            qCritical().noquote() << engine.errorString();
+            return 2;
+        }
+        const double loadMs = timer.nsecsElapsed() / 1e6;
+
+        for (int batch : batchSizes) {
+            QVector<double> preprocessUs;
+            QVector<double> invokeUs;
+            QVector<double> postprocessUs;
+            QVector<double> totalUs;
+            int next = 0;
+
+            for (int iteration = 0; iteration < warmup + repeat; ++iteration) {
+                QVector<QImage> inputs;
+                for (int i = 0; i < batch; ++i) {
+                    inputs.append(images[next++ % images.size()]);
+                }
+
+                // 前處理：裁切縮放 + 填入輸入張量
+                timer.start();
+                QVector<QImage> modelImages;
+                modelImages.reserve(batch);
+                for (const QImage &image : inputs) {
+                    modelImages.append(InferenceEngine::preprocess(image));
+                }
+                if (!engine.setInput(modelImages)) {
+                    qCritical().noquote() << engine.errorString();
+                    return 2;
+                }
+                const qint64 preprocessNs = timer.nsecsElapsed();
+
+                timer.start();
+                if (!engine.invoke()) {
+                    qCritical().noquote() << engine.errorString();
+                    return 2;
+                }
+                const qint64 invokeNs = timer.nsecsElapsed();
+
+                // 後處理：讀取輸出、argmax 與 top-3
+                timer.start();
+                int checksum = 0;
+                for (const QVector<float> &scores : engine.outputs()) {
+                    checksum += engine.postprocess(scores).classIndex;
+                    checksum += InferenceEngine::topK(scores, 3).value(0);
+                }
+                const qint64 postprocessNs = timer.nsecsElapsed();
+                Q_UNUSED(checksum);
+
+                if (iteration < warmup) {
+                    continue;
+                }
+                preprocessUs.append(preprocessNs / 1000.0);
+                invokeUs.append(invokeNs / 1000.0);
+                postprocessUs.append(postprocessNs / 1000.0);
+                totalUs.append((preprocessNs + invokeNs + postprocessNs) / 1000.0);
+            }
+
+            double totalSum = 0.0;
+            for (double value : totalUs) {
+                totalSum += value;
+            }
+            QJsonObject run;
+            run["threads"] = threads;
+            run["xnnpack"] = xnnpack;
+            run["batch"] = batch;
+            run["warmup"] = warmup;
+            run["repeat"] = repeat;
+            run["loadMs"] = loadMs;
+            run["imagesPerSec"] = totalSum > 0 ? batch * repeat * 1e6 / totalSum : 0.0;
+            run["preprocessUs"] = BenchStats::summarize(preprocessUs);
+            run["invokeUs"] = BenchStats::summarize(invokeUs);
+            run["postprocessUs"] = BenchStats::summarize(postprocessUs);
+            run["totalUs"] = BenchStats::summarize(totalUs);
+            runs.append(run);
+
+            qInfo().noquote() << QString("threads=%1%2 batch=%3: %4 img/s, invoke p50 %5 us p99 %6 us")
+                                     .arg(threads).arg(xnnpack ? " xnnpack" : "").arg(batch)
+                                     .arg(run["imagesPerSec"].toDouble(), 0, 'f', 1)
+                                     .arg(BenchStats::percentile(invokeUs, 50), 0, 'f', 0)
+                                     .arg(BenchStats::percentile(invokeUs, 99), 0, 'f', 0);
+        }
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "inference";
+    report["model"] = parser.value("model");
+    report["images"] = int(images.size());
+    report["grayscale"] = parser.isSet("grayscale");
+    report["runs"] = runs;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet("output")) {
+        QFile out(parser.value("output"));
+        if (!out.open(QIODevice::WriteOnly)) {
+            qCritical().noquote() << "無法寫入輸出檔：" + parser.value("output");
+            return 1;
+        }
+        out.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
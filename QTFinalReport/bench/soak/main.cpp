@@ -0,0 +1,481 @@
+﻿// 長時間自動對局測試（soak test）
+//
+// 在 offscreen 平台上驅動 MainWindow 完整跑完每一局：開始、畫出合成筆畫、提交、
+// 看結果、總結頁、再玩一局，依 MainWindow::gameState() 決定下一步。辨識預設使用 mock 後端（固定延遲、依 --error-rate 答錯），只量測 GUI 本身；
+// --classifier fileshare 改由程序內的替身模擬 watch_images.py + lite.py 的檔案協定，--model 改用程序內模型，
+// 歷史歸檔與筆畫錄製在暫存資料夾內打開，每局記錄 RSS、handle 數、QObject／QWidget／點陣圖數、
+// result.txt、歸檔與錄製的大小、提交延遲，
+// 暖機後的第一段與最後一段比較，成長超過門檻就以非 0 結束碼失敗。
+//
+// 用法：
+//   QT_QPA_PLATFORM=offscreen ./soak [--games 500] [--warmup-games 20] [--window 50]
+//       [--classifier mock|fileshare|tflite] [--error-rate 0.2] [--classifier-latency-ms 5] [--poll-delay-ms 20]
+//       [--max-rss-growth-mb 20] [--max-handle-growth 16] [--max-object-growth 0]
+//       [--max-result-log-growth 4096] [--max-latency-ratio 1.5] [--output soak.csv]
+
+#include "mainwindow.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+const QStringList standInLabels = {"airplane", "bus", "cat", "clock", "fish", "flower", "key", "spider", "star", "tree"};
+
+qint64 residentBytes() {
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+    return -1;
+#elif defined(Q_OS_LINUX)
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.value(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+int handleCount() {
+#if defined(Q_OS_WIN)
+    DWORD handles = 0;
+    GetProcessHandleCount(GetCurrentProcess(), &handles);
+    return int(handles) + int(GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS))
+           + int(GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS));
+#elif defined(Q_OS_LINUX)
+    return QDir("/proc/self/fd").entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size();
+#else
+    return -1;
+#endif
+}
+
+// 資料夾內所有檔案的大小總和（歸檔本來就會逐局成長，只記錄不設門檻）
+qint64 folderBytes(const QString &path) {
+    qint64 total = 0;
+    QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        total += it.fileInfo().size();
+    }
+    return total;
+}
+
+double median(QVector<double> values) {
+    if (values.isEmpty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+// 替身辨識器：監看 images 資料夾，依檔名寫出與 lite.py 相同格式的結果並把圖片移到 resultfile
+class StandInClassifier {
+public:
+    StandInClassifier(const AppConfig &config, double errorRate, int latencyMs)
+        : config(config), errorRate(errorRate), latencyMs(latencyMs), rng(7) {
+        QDir().mkpath(config.imageFolderPath());
+        watcher.addPath(config.imageFolderPath());
+        QObject::connect(&watcher, &QFileSystemWatcher::directoryChanged, &watcher, [this]() { scan(); });
+    }
+
+private:
+    void scan() {
+        const QStringList images = QDir(config.imageFolderPath()).entryList({"*.png"}, QDir::Files);
+        for (const QString &image : images) {
+            if (inFlight.contains(image)) {
+                continue;
+            }
+            inFlight.insert(image);
+            QTimer::singleShot(latencyMs, &watcher, [this, image]() { respond(image); });
+        }
+    }
+
+    void respond(const QString &image) {
+        inFlight.remove(image);
+        const QString question = QFileInfo(image).completeBaseName().toLower();
+        QString predicted = question;
+        if (std::uniform_real_distribution<double>(0, 1)(rng) < errorRate) {
+            predicted = standInLabels[std::uniform_int_distribution<int>(0, standInLabels.size() - 1)(rng)];
+        }
+
+        QDir().mkpath(config.resultFolderPath());
+        const QString target = config.resultFolderPath() + "/" + image;
+        QFile::remove(target);
+        QFile::rename(config.imageFolderPath() + "/" + image, target);
+
+        QFile resultFile(config.resultFilePath());
+        if (resultFile.open(QIODevice::Append | QIODevice::Text)) {
+            QTextStream(&resultFile) << "Image: " << image << " | Predicted Class: " << predicted
+                                     << " | Confidence: 0.90 | Result: " << (predicted == question ? "yes" : "no") << "\n";
+        }
+    }
+
+    AppConfig config;
+    double errorRate;
+    int latencyMs;
+    std::mt19937 rng;
+    QFileSystemWatcher watcher;
+    QSet<QString> inFlight;
+};
+
+struct Sample {
+    int game = 0;
+    double elapsedSec = 0.0;
+    qint64 rssBytes = 0;
+    int handles = 0;
+    ResourceStats resources;
+    qint64 resultLogBytes = 0;
+    qint64 historyBytes = 0;
+    qint64 recordingsBytes = 0;
+    double latencyMedianMs = 0.0;
+    double latencyMaxMs = 0.0;
+};
+
+struct Options {
+    int games = 500;
+    int warmupGames = 20;
+    int window = 50;
+    int roundTimeoutMs = 10000;
+    double maxRssGrowthMb = 20;
+    int maxHandleGrowth = 16;
+    int maxObjectGrowth = 0;
+    qint64 maxResultLogGrowth = 4096;
+    double maxLatencyRatio = 1.5;
+    QString output = "soak.csv";
+};
+
+// 以計時器輪詢遊戲狀態，模擬玩家操作；除了總結頁與辨識中視窗，出現其他 modal 視窗或錯誤提示都算失敗
+class SoakDriver {
+public:
+    SoakDriver(MainWindow &window, const AppConfig &config, const Options &options)
+        : window(window), config(config), options(options), rng(11) {
+        startButton = window.findChild<QPushButton *>("startButton");
+        saveButton = window.findChild<QPushButton *>("saveButton");
+        canvas = window.findChild<Canvas *>("canvas");
+        QObject::connect(&ticker, &QTimer::timeout, &ticker, [this]() { tick(); });
+        // 辨識與下一題的作畫重疊，延遲以每次提交自己的時間計算，而不是上一次按下保存的時間
+        QObject::connect(&window, &MainWindow::answerShown, &ticker, [this](bool, qint64 submittedMicros) {
+            if (submittedMicros > 0) {
+                gameLatencies.append((SubmissionLatency::nowMicros() - submittedMicros) / 1e3);
+            }
+        });
+        QObject::connect(window.findChild<Toast *>("toast"), &Toast::messageShown, &ticker,
+                         [this](const QString &text, Toast::Style style) {
+            if (style == Toast::Error) {
+                qWarning().noquote() << "非預期的錯誤提示：" + text;
+                ++unexpectedDialogs;
+            }
+        });
+    }
+
+    void start() {
+        clock.start();
+        ticker.start(2);
+    }
+
+private:
+    void tick() {
+        QWidget *modal = QApplication::activeModalWidget();
+        if (modal && modal->objectName() != "progressDialog" && modal->objectName() != "summaryDialog") {
+            qWarning().noquote() << "非預期的視窗：" + modal->windowTitle();
+            ++unexpectedDialogs;
+            modal->close();
+            return;
+        }
+
+        switch (window.gameState()) {
+        case MainWindow::GameState::Idle:
+            if (startButton->isVisible() && startButton->isEnabled()) {
+                startButton->click();
+            }
+            break;
+        case MainWindow::GameState::Drawing:
+            drawStrokes();
+            roundClock.start();
+            saveButton->click();   // 提交後立刻換到下一題（或最後一題的 Submitting），下一輪畫的是新題目
+            break;
+        case MainWindow::GameState::Submitting:
+            if (roundClock.elapsed() > options.roundTimeoutMs) {
+                fail(QString("第 %1 局等待辨識結果逾時").arg(samples.size() + 1));
+            }
+            break;
+        case MainWindow::GameState::Result:
+            break;   // 最後一題的結果停留 resultDisplayMs 後自動顯示總結
+        case MainWindow::GameState::Summary:
+            if (modal && modal->objectName() == "summaryDialog") {
+                finishGame(modal);
+            }
+            break;
+        }
+    }
+
+    void finishGame(QWidget *summaryDialog) {
+        recordSample();
+        if (samples.size() >= options.games) {
+            finish();
+            return;
+        }
+        summaryDialog->findChild<QPushButton *>("playAgainButton")->click();
+    }
+
+    void drawStrokes() {
+        std::uniform_real_distribution<double> x(0, canvas->width() - 1);
+        std::uniform_real_distribution<double> y(0, canvas->height() - 1);
+        for (int stroke = 0; stroke < 5; ++stroke) {
+            QPointF point(x(rng), y(rng));
+            send(QEvent::MouseButtonPress, point, Qt::LeftButton, Qt::LeftButton);
+            for (int i = 0; i < 20; ++i) {
+                point = QPointF(x(rng), y(rng));
+                send(QEvent::MouseMove, point, Qt::NoButton, Qt::LeftButton);
+            }
+            send(QEvent::MouseButtonRelease, point, Qt::LeftButton, Qt::NoButton);
+        }
+    }
+
+    void send(QEvent::Type type, const QPointF &pos, Qt::MouseButton button, Qt::MouseButtons buttons) {
+        QMouseEvent event(type, pos, canvas->mapToGlobal(pos), button, buttons, Qt::NoModifier);
+        QCoreApplication::sendEvent(canvas, &event);
+    }
+
+    void recordSample() {
+        Sample sample;
+        sample.game = samples.size() + 1;
+        sample.elapsedSec = clock.elapsed() / 1000.0;
+        sample.rssBytes = residentBytes();
+        sample.handles = handleCount();
+        sample.resources = window.resourceStats();
+        sample.resultLogBytes = QFileInfo(config.resultFilePath()).size();
+        sample.historyBytes = folderBytes(config.historyDir);
+        sample.recordingsBytes = folderBytes(config.recordingsDir);
+        sample.latencyMedianMs = median(gameLatencies);
+        sample.latencyMaxMs = gameLatencies.isEmpty() ? 0.0 : *std::max_element(gameLatencies.begin(), gameLatencies.end());
+        gameLatencies.clear();
+        samples.append(sample);
+
+        if (sample.game % 50 == 0) {
+            qInfo().noquote() << QString("game %1: rss %2 MB, handles %3, objects %4, latency p50 %5 ms")
+                                     .arg(sample.game).arg(sample.rssBytes / 1048576.0, 0, 'f', 1)
+                                     .arg(sample.handles).arg(sample.resources.objects)
+                                     .arg(sample.latencyMedianMs, 0, 'f', 1);
+        }
+    }
+
+    // 比較暖機後第一段與最後一段的平均值
+    QStringList evaluate() const {
+        QStringList failures;
+        if (unexpectedDialogs > 0) {
+            failures << QString("出現 %1 個非預期的對話框或錯誤提示").arg(unexpectedDialogs);
+        }
+        int window = options.window;
+        if (samples.size() < options.warmupGames + 2 * window) {
+            window = (samples.size() - options.warmupGames) / 2;
+        }
+        if (window < 1) {
+            qWarning() << "局數太少，略過成長檢查";
+            return failures;
+        }
+        const auto average = [this, window](int first, auto field) {
+            double sum = 0.0;
+            for (int i = first; i < first + window; ++i) {
+                sum += field(samples[i]);
+            }
+            return sum / window;
+        };
+        const int baseline = options.warmupGames;
+        const int last = samples.size() - window;
+        const auto growth = [&](auto field) { return average(last, field) - average(baseline, field); };
+
+        const double rssGrowthMb = growth([](const Sample &s) { return s.rssBytes / 1048576.0; });
+        if (rssGrowthMb > options.maxRssGrowthMb) {
+            failures << QString("RSS 成長 %1 MB（上限 %2）").arg(rssGrowthMb, 0, 'f', 1).arg(options.maxRssGrowthMb);
+        }
+        const double handleGrowth = growth([](const Sample &s) { return double(s.handles); });
+        if (handleGrowth > options.maxHandleGrowth) {
+            failures << QString("handle 成長 %1（上限 %2）").arg(handleGrowth, 0, 'f', 1).arg(options.maxHandleGrowth);
+        }
+        const double objectGrowth = growth([](const Sample &s) { return double(s.resources.objects); });
+        if (objectGrowth > options.maxObjectGrowth) {
+            failures << QString("QObject 成長 %1（上限 %2）").arg(objectGrowth, 0, 'f', 1).arg(options.maxObjectGrowth);
+        }
+        const double widgetGrowth = growth([](const Sample &s) { return double(s.resources.widgets); });
+        if (widgetGrowth > options.maxObjectGrowth) {
+            failures << QString("QWidget 成長 %1（上限 %2）").arg(widgetGrowth, 0, 'f', 1).arg(options.maxObjectGrowth);
+        }
+        const double logGrowth = growth([](const Sample &s) { return double(s.resultLogBytes); });
+        if (logGrowth > options.maxResultLogGrowth) {
+            failures << QString("result.txt 成長 %1 bytes（上限 %2）").arg(logGrowth, 0, 'f', 0).arg(options.maxResultLogGrowth);
+        }
+        const double baseLatency = qMax(1.0, average(baseline, [](const Sample &s) { return s.latencyMedianMs; }));
+        const double lastLatency = average(last, [](const Sample &s) { return s.latencyMedianMs; });
+        if (lastLatency / baseLatency > options.maxLatencyRatio) {
+            failures << QString("提交延遲由 %1 ms 變為 %2 ms（上限 %3 倍）")
+                            .arg(baseLatency, 0, 'f', 1).arg(lastLatency, 0, 'f', 1).arg(options.maxLatencyRatio);
+        }
+        return failures;
+    }
+
+    void writeSamples() const {
+        QFile file(options.output);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            qWarning().noquote() << "無法寫入 " + options.output;
+            return;
+        }
+        QTextStream out(&file);
+        out << "game,elapsed_s,rss_bytes,handles,objects,widgets,pixmaps,pixmap_bytes,result_log_bytes,history_bytes,recordings_bytes,latency_p50_ms,latency_max_ms\n";
+        for (const Sample &s : samples) {
+            out << s.game << ',' << s.elapsedSec << ',' << s.rssBytes << ',' << s.handles << ','
+                << s.resources.objects << ',' << s.resources.widgets << ',' << s.resources.pixmaps << ','
+                << s.resources.pixmapBytes << ',' << s.resultLogBytes << ',' << s.historyBytes << ',' << s.recordingsBytes << ','
+                << s.latencyMedianMs << ','
+                << s.latencyMaxMs << '\n';
+        }
+    }
+
+    void finish() {
+        ticker.stop();
+        writeSamples();
+        const QStringList failures = evaluate();
+        if (failures.isEmpty()) {
+            qInfo().noquote() << QString("PASS：%1 局，%2 秒").arg(samples.size()).arg(clock.elapsed() / 1000.0, 0, 'f', 1);
+            QCoreApplication::exit(0);
+        } else {
+            for (const QString &failure : failures) {
+                qCritical().noquote() << "FAIL：" + failure;
+            }
+            QCoreApplication::exit(1);
+        }
+    }
+
+    void fail(const QString &reason) {
+        ticker.stop();
+        writeSamples();
+        qCritical().noquote() << "FAIL：" + reason;
+        QCoreApplication::exit(1);
+    }
+
+    MainWindow &window;
+    AppConfig config;
+    Options options;
+    std::mt19937 rng;
+    QTimer ticker;
+    QElapsedTimer clock;
+    QElapsedTimer roundClock;
+    QPushButton *startButton;
+    QPushButton *saveButton;
+    Canvas *canvas;
+    QVector<double> gameLatencies;
+    QVector<Sample> samples;
+    int unexpectedDialogs = 0;
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("soak");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MainWindow 長時間自動對局測試");
+    parser.addHelpOption();
+    parser.addOption({"games", "要跑的局數", "count", "500"});
+    parser.addOption({"warmup-games", "不列入比較的暖機局數", "count", "20"});
+    parser.addOption({"window", "比較時取的局數", "count", "50"});
+    parser.addOption({"classifier", "辨識後端：mock、fileshare（替身 Python 流程）或 tflite（預設 mock，指定 --model 時為 tflite）",
+                      "backend"});
+    parser.addOption({"error-rate", "mock／替身辨識器答錯的機率", "ratio", "0.2"});
+    parser.addOption({"classifier-latency-ms", "mock／替身辨識器的回應延遲", "ms", "5"});
+    parser.addOption({"poll-delay-ms", "提交後開始檢查 result.txt 的延遲", "ms", "20"});
+    parser.addOption({"round-timeout-ms", "單題等待結果的上限", "ms", "10000"});
+    parser.addOption({"max-rss-growth-mb", "RSS 成長上限", "mb", "20"});
+    parser.addOption({"max-handle-growth", "handle 數成長上限", "count", "16"});
+    parser.addOption({"max-object-growth", "QObject／QWidget 數成長上限", "count", "0"});
+    parser.addOption({"max-result-log-growth", "result.txt 大小成長上限", "bytes", "4096"});
+    parser.addOption({"max-latency-ratio", "提交延遲中位數可接受的倍數", "ratio", "1.5"});
+    parser.addOption({"model", "改用程序內模型（需以 TFLite 編譯）", "file"});
+    parser.addOption({"labels", "程序內模型的標籤檔", "file"});
+    parser.addOption({"output", "每局紀錄的 CSV 檔", "file", "soak.csv"});
+    parser.process(app);
+
+    Options options;
+    options.games = qMax(1, parser.value("games").toInt());
+    options.warmupGames = qMax(0, parser.value("warmup-games").toInt());
+    options.window = qMax(1, parser.value("window").toInt());
+    options.roundTimeoutMs = parser.value("round-timeout-ms").toInt();
+    options.maxRssGrowthMb = parser.value("max-rss-growth-mb").toDouble();
+    options.maxHandleGrowth = parser.value("max-handle-growth").toInt();
+    options.maxObjectGrowth = parser.value("max-object-growth").toInt();
+    options.maxResultLogGrowth = parser.value("max-result-log-growth").toLongLong();
+    options.maxLatencyRatio = parser.value("max-latency-ratio").toDouble();
+    options.output = parser.value("output");
+
+    QTemporaryDir dataDir;
+    if (!dataDir.isValid()) {
+        qCritical() << "無法建立暫存資料夾";
+        return 1;
+    }
+
+    AppConfig config;
+    config.dataDir = dataDir.path();
+    config.historyDir = dataDir.filePath("history");   // 歸檔與錄製預設關閉，soak 在暫存資料夾內打開以一併跑到
+    config.recordingsDir = dataDir.filePath("recordings");
+    config.modelPath = parser.isSet("model") ? parser.value("model") : dataDir.filePath("no-model.tflite");
+    config.labelsPath = parser.isSet("labels") ? parser.value("labels") : dataDir.filePath("labels.txt");
+    if (!parser.isSet("labels")) {
+        // 題目池取自標籤檔，格式與 cv/labels.txt 相同
+        QFile labelsFile(config.labelsPath);
+        if (labelsFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream out(&labelsFile);
+            for (int i = 0; i < standInLabels.size(); ++i) {
+                out << i << ' ' << standInLabels[i] << '\n';
+            }
+        }
+    }
+    config.warmupRuns = 1;
+    config.resultPollDelayMs = parser.value("poll-delay-ms").toInt();
+    config.resultPollIntervalMs = 5;
+    config.latencyLogEvery = 0;
+    config.resultDisplayMs = 0;   // 最後一題不必停留看結果，直接顯示總結
+    config.classifierBackend = parser.value("classifier").toLower();
+    if (config.classifierBackend.isEmpty()) {
+        config.classifierBackend = parser.isSet("model") ? "tflite" : "mock";
+    }
+    config.mockLatencyMs = qMax(0, parser.value("classifier-latency-ms").toInt());
+    config.mockAccuracy = qBound(0.0, 1.0 - parser.value("error-rate").toDouble(), 1.0);
+
+    std::unique_ptr<StandInClassifier> standIn;
+    if (config.classifierBackend == "fileshare") {
+        standIn = std::make_unique<StandInClassifier>(config, parser.value("error-rate").toDouble(),
+                                                      parser.value("classifier-latency-ms").toInt());
+    }
+    MainWindow window(config);
+    window.show();
+
+    SoakDriver driver(window, config, options);
+    driver.start();
+    return app.exec();
+}
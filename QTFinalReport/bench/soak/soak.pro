@@ -0,0 +1,16 @@
+# 長時間自動對局測試（soak test）
+# 以 QT_QPA_PLATFORM=offscreen 執行，用本地替身辨識器驅動 MainWindow 跑上千局
+
+QT += core gui widgets concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = soak
+
+SOURCES += \
+    main.cpp
+
+include(../../game.pri)
+
+win32: LIBS += -lpsapi -luser32
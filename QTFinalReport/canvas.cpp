@@ -0,0 +1,396 @@
+﻿#include "canvas.h"
+#include <QTouchEvent>
+
+namespace {
+bool isGray(const QColor &color) {
+    return color.red() == color.green() && color.green() == color.blue();
+}
+}
+
+Canvas::Canvas(QWidget *parent) : QWidget(parent), drawing(false) {
+    setFixedSize(900, 600); // 畫布大小
+    resetSurface(size());
+    brushColor = Qt::black;
+    brushSize = 5;
+    setAttribute(Qt::WA_AcceptTouchEvents);
+
+    if (qEnvironmentVariableIntValue("QUICKDRAW_HUD") != 0) {
+        setHudEnabled(true);
+    }
+}
+
+void Canvas::setCanvasSize(const QSize &size) {
+    setFixedSize(size);
+    resetSurface(size);
+    update();
+}
+
+void Canvas::resetSurface(const QSize &size) {
+    surface = QImage(size, grayscaleEnabled ? QImage::Format_Grayscale8 : QImage::Format_RGB32);
+    surface.fill(Qt::white);
+    blank = true;
+    spare = Frame();
+    resetModelSurface();
+}
+
+// 模型緩衝的格式跟著畫布（灰階或彩色），並直接使用前處理的輸出格式
+void Canvas::resetModelSurface() {
+    spare.modelImage = QImage();   // 大小或格式可能改變，下次換題時重建
+    if (modelInputSize <= 0) {
+        modelSurface = QImage();
+        return;
+    }
+    const bool gray = surface.format() == QImage::Format_Grayscale8;
+    modelSurface = QImage(modelInputSize, modelInputSize, gray ? QImage::Format_Grayscale8 : QImage::Format_RGB888);
+    modelSurface.fill(Qt::white);
+
+    const int side = qMin(surface.width(), surface.height());
+    const double scale = double(modelInputSize) / side;
+    modelTransform = QTransform::fromScale(scale, scale);
+    modelTransform.translate(-(surface.width() - side) / 2, -(surface.height() - side) / 2);
+}
+
+void Canvas::setModelInputSize(int side) {
+    modelInputSize = qMax(0, side);
+    resetModelSurface();
+    if (!modelSurface.isNull()) {
+        // 已經畫了的內容縮放一次補進去，之後逐筆同步
+        const int cropSide = qMin(surface.width(), surface.height());
+        QPainter painter(&modelSurface);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(QRect(0, 0, modelInputSize, modelInputSize), surface,
+                          QRect((surface.width() - cropSide) / 2, (surface.height() - cropSide) / 2, cropSide, cropSide));
+    }
+}
+
+QImage Canvas::modelImage() const {
+    return modelSurface;
+}
+
+void Canvas::setGrayscale(bool enabled) {
+    grayscaleEnabled = enabled;
+    if (!blank) {
+        return;   // 已畫的內容不轉換，由 clearCanvas 或 takeFrame 換上新格式的緩衝
+    }
+    if (enabled && surface.format() != QImage::Format_Grayscale8) {
+        surface = surface.convertToFormat(QImage::Format_Grayscale8);
+        modelSurface = modelSurface.convertToFormat(QImage::Format_Grayscale8);
+    } else if (!enabled && surface.format() == QImage::Format_Grayscale8) {
+        surface = surface.convertToFormat(QImage::Format_RGB32);
+        modelSurface = modelSurface.convertToFormat(QImage::Format_RGB888);
+    }
+    update();
+}
+
+bool Canvas::isGrayscale() const {
+    return surface.format() == QImage::Format_Grayscale8;
+}
+
+void Canvas::setBrushColor(const QColor &color) {
+    brushColor = color;
+}
+
+void Canvas::setBrushSize(int size) {
+    brushSize = size;
+}
+
+void Canvas::setEraser() {
+    brushColor = Qt::white;
+}
+
+QImage Canvas::image() const {
+    return surface;
+}
+
+QPixmap Canvas::getPixmap() const {
+    return QPixmap::fromImage(surface);
+}
+
+bool Canvas::event(QEvent *event) {
+    switch (event->type()) {
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd:
+    case QEvent::TouchCancel: {
+        const auto *touch = static_cast<QTouchEvent *>(event);
+        for (const QEventPoint &point : touch->points()) {
+            const QPoint pos = point.position().toPoint();
+            if (point.state() == QEventPoint::Pressed) {
+                touchPositions.insert(point.id(), pos);
+                recorder.beginStroke(point.id(), pos, brushColor, brushSize);
+            } else if (point.state() == QEventPoint::Updated) {
+                drawSegment(touchPositions.value(point.id(), pos), pos);
+                touchPositions.insert(point.id(), pos);
+                recorder.addPoint(point.id(), pos);
+            } else if (point.state() == QEventPoint::Released) {
+                touchPositions.remove(point.id());
+                recorder.endStroke(point.id());
+            }
+        }
+        if (event->type() == QEvent::TouchEnd || event->type() == QEvent::TouchCancel) {
+            for (auto it = touchPositions.constBegin(); it != touchPositions.constEnd(); ++it) {
+                recorder.endStroke(it.key());
+            }
+            touchPositions.clear();
+        }
+        event->accept();   // 接受 TouchBegin 後 Qt 不再由觸控合成滑鼠事件
+        return true;
+    }
+    default:
+        return QWidget::event(event);
+    }
+}
+
+void Canvas::mousePressEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) {
+        drawing = true;
+        lastPos = event->pos();
+        recorder.beginStroke(-1, lastPos, brushColor, brushSize);
+        if (hudEnabled) {
+            noteInput();
+        }
+    }
+}
+
+void Canvas::mouseMoveEvent(QMouseEvent *event) {
+    if (drawing && event->buttons() & Qt::LeftButton) {
+        drawSegment(lastPos, event->pos());
+        lastPos = event->pos();
+        recorder.addPoint(-1, lastPos);
+    }
+}
+
+void Canvas::drawSegment(const QPoint &from, const QPoint &to) {
+    drawLine(from, to, brushColor, brushSize);
+    if (hudEnabled) {
+        noteInput();
+    }
+}
+
+void Canvas::drawLine(const QPoint &from, const QPoint &to, const QColor &color, int width) {
+    if (surface.format() == QImage::Format_Grayscale8 && !isGray(color)) {
+        surface = surface.convertToFormat(QImage::Format_RGB32);   // 第一筆彩色筆畫
+        modelSurface = modelSurface.convertToFormat(QImage::Format_RGB888);
+    }
+    QPainter painter(&surface);
+    QPen pen(color, width, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+    painter.setPen(pen);
+    painter.drawLine(from, to);
+
+    // 同一筆畫進模型緩衝：畫筆寬度隨座標轉換縮小，反鋸齒取代事後的平滑縮放
+    if (!modelSurface.isNull()) {
+        QPainter modelPainter(&modelSurface);
+        modelPainter.setRenderHint(QPainter::Antialiasing);
+        modelPainter.setTransform(modelTransform);
+        modelPainter.setPen(pen);
+        modelPainter.drawLine(from, to);
+    }
+    ++revisionCounter;
+    blank = false;
+    if (hudEnabled) {
+        update();   // HUD 的數字也要重畫
+    } else {
+        // 只重繪這一段涵蓋的範圍：灰階畫布重繪時要轉換格式，整張重繪每段都要轉 900x600 像素
+        const int margin = width / 2 + 2;
+        update(QRect(from, to).normalized().adjusted(-margin, -margin, margin, margin));
+    }
+}
+
+void Canvas::mouseReleaseEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) {
+        drawing = false;
+        recorder.endStroke(-1);
+    }
+}
+
+void Canvas::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    if (!hudEnabled) {
+        painter.drawImage(event->rect(), surface, event->rect());
+        return;
+    }
+
+    QElapsedTimer paintClock;
+    paintClock.start();
+    painter.drawImage(0, 0, surface);
+    paintMs.add(paintClock.nsecsElapsed() / 1e6);
+
+    if (eventsSinceLastPaint > 0) {
+        inputToPaintMs.add(inputClock.nsecsElapsed() / 1e6);
+        eventsPerFrame.add(eventsSinceLastPaint);
+        eventsSinceLastPaint = 0;
+    }
+    drawHud(painter);
+}
+
+// 換上的緩衝一律是設定中的格式：灰階模式下彩色畫完一題，下一題回到灰階（與 clearCanvas 相同）
+QImage::Format Canvas::blankFormat() const {
+    return grayscaleEnabled ? QImage::Format_Grayscale8 : QImage::Format_RGB32;
+}
+
+QImage::Format Canvas::blankModelFormat() const {
+    return grayscaleEnabled ? QImage::Format_Grayscale8 : QImage::Format_RGB888;
+}
+
+bool Canvas::isBlankCompatible(const Frame &frame) const {
+    if (frame.image.size() != surface.size() || frame.image.format() != blankFormat()) {
+        return false;
+    }
+    if (modelInputSize <= 0) {
+        return frame.modelImage.isNull();
+    }
+    return frame.modelImage.size() == QSize(modelInputSize, modelInputSize)
+           && frame.modelImage.format() == blankModelFormat();
+}
+
+Canvas::Frame Canvas::takeFrame() {
+    if (!isBlankCompatible(spare)) {
+        // 沒有可用的備用緩衝（第一次換題，或上一張還在辨識）才配置新的
+        spare.image = QImage(surface.size(), blankFormat());
+        spare.image.fill(Qt::white);
+        spare.modelImage = QImage();
+        if (modelInputSize > 0) {
+            spare.modelImage = QImage(modelInputSize, modelInputSize, blankModelFormat());
+            spare.modelImage.fill(Qt::white);
+        }
+    }
+    Frame frame{std::move(surface), std::move(modelSurface)};
+    surface = std::move(spare.image);
+    modelSurface = std::move(spare.modelImage);
+    spare = Frame();
+    blank = true;
+
+    ++revisionCounter;
+    recorder.clear();
+    update();
+    return frame;
+}
+
+// 呼叫端應先放掉其他複本，像素只剩這一份時填白不會重新配置
+void Canvas::recycleFrame(Frame frame) {
+    if (!isBlankCompatible(frame)) {
+        return;   // 彩色筆畫、換了大小或格式的舊緩衝直接釋放
+    }
+    frame.image.fill(Qt::white);
+    if (!frame.modelImage.isNull()) {
+        frame.modelImage.fill(Qt::white);
+    }
+    spare = std::move(frame);
+}
+
+void Canvas::clearCanvas() {
+    if (surface.format() != blankFormat()) {
+        resetSurface(surface.size());   // 彩色畫完一題後回到灰階，或套用作畫途中變更的設定
+    } else {
+        surface.fill(Qt::white); // 填充白色
+        modelSurface.fill(Qt::white);
+    }
+    ++revisionCounter;
+    blank = true;
+    recorder.clear();
+    update(); // 更新畫布
+}
+
+quint64 Canvas::revision() const {
+    return revisionCounter;
+}
+
+void Canvas::startRecording(const QString &label) {
+    recorder.start(size(), label);
+}
+
+StrokeRecording Canvas::takeRecording() {
+    return recorder.take();
+}
+
+void Canvas::setHudEnabled(bool enabled) {
+    if (hudEnabled == enabled) {
+        return;
+    }
+    hudEnabled = enabled;
+    if (enabled) {
+        paintMs.clear();
+        inputToPaintMs.clear();
+        eventsPerFrame.clear();
+        stallMs.clear();
+        eventsSinceLastPaint = 0;
+        if (!stallTimer) {
+            stallTimer = new QTimer(this);
+            stallTimer->setTimerType(Qt::PreciseTimer);
+            connect(stallTimer, &QTimer::timeout, this, &Canvas::checkEventLoopStall);
+        }
+        stallClock.start();
+        stallTimer->start(16);
+    } else if (stallTimer) {
+        stallTimer->stop();
+    }
+    update();
+}
+
+bool Canvas::isHudEnabled() const {
+    return hudEnabled;
+}
+
+// 記錄一個輸入事件；自上次重繪後的第一個事件開始計算輸入到重繪的延遲
+void Canvas::noteInput() {
+    if (eventsSinceLastPaint++ == 0) {
+        inputClock.start();
+    }
+}
+
+// 16 ms 計時器實際間隔超出的部分即為事件迴圈被卡住的時間
+void Canvas::checkEventLoopStall() {
+    const double elapsedMs = stallClock.nsecsElapsed() / 1e6;
+    stallClock.start();
+    stallMs.add(qMax(0.0, elapsedMs - stallTimer->interval()));
+
+    // 約每 250 ms 更新一次 HUD 區域，沒有輸入時數字也會刷新
+    if (++stallTicks % 16 == 0) {
+        update(QRect(0, 0, 260, 90));
+    }
+}
+
+void Canvas::drawHud(QPainter &painter) {
+    const QRect box(0, 0, 260, 90);
+    painter.fillRect(box, QColor(0, 0, 0, 170));
+    painter.setPen(Qt::white);
+    QFont font("Consolas");
+    font.setStyleHint(QFont::Monospace);
+    font.setPixelSize(13);
+    painter.setFont(font);
+
+    const QStringList lines = {
+        QString("paint        %1 / %2 ms").arg(paintMs.average(), 5, 'f', 2).arg(paintMs.maximum(), 6, 'f', 2),
+        QString("input->paint %1 / %2 ms").arg(inputToPaintMs.average(), 5, 'f', 2).arg(inputToPaintMs.maximum(), 6, 'f', 2),
+        QString("events/frame %1 / %2").arg(eventsPerFrame.average(), 5, 'f', 1).arg(eventsPerFrame.maximum(), 6, 'f', 0),
+        QString("loop stall   %1 / %2 ms").arg(stallMs.average(), 5, 'f', 2).arg(stallMs.maximum(), 6, 'f', 1),
+    };
+    painter.drawText(box.adjusted(8, 6, -8, -6), Qt::AlignLeft | Qt::AlignTop, lines.join('\n'));
+}
+
+void Canvas::RollingStat::add(double value) {
+    samples[next] = value;
+    next = (next + 1) % int(samples.size());
+    count = qMin(count + 1, int(samples.size()));
+}
+
+void Canvas::RollingStat::clear() {
+    count = 0;
+    next = 0;
+}
+
+double Canvas::RollingStat::average() const {
+    double sum = 0.0;
+    for (int i = 0; i < count; ++i) {
+        sum += samples[i];
+    }
+    return count ? sum / count : 0.0;
+}
+
+double Canvas::RollingStat::maximum() const {
+    double result = 0.0;
+    for (int i = 0; i < count; ++i) {
+        result = qMax(result, samples[i]);
+    }
+    return result;
+}
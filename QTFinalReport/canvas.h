@@ -0,0 +1,119 @@
+﻿#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <QWidget>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QImage>
+#include <QPixmap>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QTransform>
+#include <QHash>
+#include <array>
+#include "strokerecording.h"
+
+class Canvas : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit Canvas(QWidget *parent = nullptr);
+    void setCanvasSize(const QSize &size);   // 預設 900x600，多人分割畫面時縮小
+    void setBrushColor(const QColor &color);
+    void setBrushSize(int size);
+    void setEraser();
+
+    // 單色模式：畫布以 8 位元灰階儲存，匯出的 PNG 與模型輸入也維持單通道，記憶體與頻寬約為彩色的 1/4
+    // 畫上非灰色的筆畫時自動轉成 32 位元彩色，清除畫布後再回到灰階
+    // 畫布空白時立即切換；已有筆畫時只記下設定，下次清除或換題才生效，不會改動已畫的內容
+    void setGrayscale(bool enabled);
+    bool isGrayscale() const;    // 目前是否以灰階儲存
+    QImage image() const;        // 畫布內容（Grayscale8 或 RGB32），與畫布共用像素直到下一筆
+    QPixmap getPixmap() const;
+
+    // 模型解析度緩衝：每一筆同時以反鋸齒畫進 side x side 的影像，筆刷寬度等比縮小
+    // 範圍與 InferenceEngine::preprocess 相同（置中裁成正方形），提交與背景辨識直接取用，不必再縮放整張畫布
+    void setModelInputSize(int side);   // 0 = 停用
+    QImage modelImage() const;          // Grayscale8 或 RGB888；停用時為空影像
+
+    // 雙緩衝：提交時交出目前的畫布與模型緩衝（不複製像素），立刻換上已清空的備用緩衝
+    // 辨識用完後把 Frame 還回來，在作畫期間事先清空，下次換題就不必配置或填白
+    struct Frame {
+        QImage image;        // 畫布內容
+        QImage modelImage;   // 模型解析度緩衝；停用時為空影像
+    };
+    Frame takeFrame();
+    void recycleFrame(Frame frame);
+
+    void clearCanvas();
+    quint64 revision() const;   // 每畫一段或清除就加一，用來判斷畫布是否有變化
+    void drawLine(const QPoint &from, const QPoint &to, const QColor &color, int width);   // 重播用，不經過輸入事件
+
+    // 錄製玩家的筆畫（只記錄滑鼠與觸控輸入，重播畫上去的不會被錄進去）
+    void startRecording(const QString &label);
+    StrokeRecording takeRecording();
+
+    // 效能抬頭顯示（HUD）：重繪耗時、輸入到重繪延遲、每格合併事件數、事件迴圈卡頓
+    // 關閉時只多一個布林判斷；環境變數 QUICKDRAW_HUD=1 可預設開啟
+    void setHudEnabled(bool enabled);
+    bool isHudEnabled() const;
+
+protected:
+    // 觸控點各自獨立畫線，多人同時在不同畫布上作畫也不會互相搶滑鼠事件
+    bool event(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    // 最近 60 個樣本的平均與最大值
+    struct RollingStat {
+        void add(double value);
+        void clear();
+        double average() const;
+        double maximum() const;
+
+        std::array<double, 60> samples{};
+        int count = 0;
+        int next = 0;
+    };
+
+    void resetSurface(const QSize &size);
+    void resetModelSurface();
+    QImage::Format blankFormat() const;
+    QImage::Format blankModelFormat() const;
+    bool isBlankCompatible(const Frame &frame) const;
+    void drawSegment(const QPoint &from, const QPoint &to);
+    void noteInput();
+    void checkEventLoopStall();
+    void drawHud(QPainter &painter);
+
+    QImage surface;
+    bool grayscaleEnabled = false;
+    QImage modelSurface;
+    QTransform modelTransform;   // 畫布座標 → 模型緩衝座標
+    int modelInputSize = 0;
+    Frame spare;                 // 已清空的備用緩衝；格式或大小不符時捨棄重建
+    QColor brushColor;
+    int brushSize;
+    QPoint lastPos;
+    bool drawing;
+    quint64 revisionCounter = 0;
+    bool blank = true;                 // 清除或換題後還沒畫任何一筆
+    QHash<int, QPoint> touchPositions;   // 觸控點 id → 上一個位置
+    StrokeRecorder recorder;
+
+    bool hudEnabled = false;
+    QTimer *stallTimer = nullptr;     // 只在 HUD 開啟時運作
+    QElapsedTimer stallClock;
+    QElapsedTimer inputClock;         // 自上次重繪後第一個輸入事件起算
+    int eventsSinceLastPaint = 0;
+    int stallTicks = 0;
+    RollingStat paintMs;
+    RollingStat inputToPaintMs;
+    RollingStat eventsPerFrame;
+    RollingStat stallMs;
+};
+
+#endif // CANVAS_H
@@ -0,0 +1,13 @@
+# 畫布元件，主程式與 bench/ 共用
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/canvas.cpp \
+    $$PWD/strokerecording.cpp \
+    $$PWD/strokereplayer.cpp
+
+HEADERS += \
+    $$PWD/canvas.h \
+    $$PWD/strokerecording.h \
+    $$PWD/strokereplayer.h
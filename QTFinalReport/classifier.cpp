@@ -0,0 +1,48 @@
+﻿#include "classifier.h"
+#include "fileshareclassifier.h"
+#include "mockclassifier.h"
+#include "remoteclassifier.h"
+#include "tfliteclassifier.h"
+#include <QTimer>
+
+Classifier::Classifier(QObject *parent) : QObject(parent) {}
+
+void Classifier::reload() {
+    QTimer::singleShot(0, this, [this]() { emit reloaded(false, modelInfo().backend + " 後端不支援重新載入"); });
+}
+
+quint64 Classifier::classify(const QImage &image, quint64 submissionId) {
+    return classifyBatch({image}, {submissionId}).value(0);
+}
+
+QVector<int> Classifier::topK(const Prediction &prediction, int k) {
+    if (prediction.scores.isEmpty()) {
+        return prediction.isValid() && k > 0 ? QVector<int>{prediction.classIndex} : QVector<int>();
+    }
+    return InferenceEngine::topK(prediction.scores, k);
+}
+
+Classifier *Classifier::create(const QString &backend, const AppConfig &config, QObject *parent) {
+    if (backend == "tflite") {
+        return new TfliteClassifier(config, parent);
+    }
+    if (backend == "server") {
+        return new RemoteClassifier(config.inferenceServer, config.inferenceTimeoutMs, parent);
+    }
+    if (backend == "fileshare") {
+        return new FileShareClassifier(config, parent);
+    }
+    if (backend == "mock") {
+        MockClassifier::Options options;
+        options.latencyMs = config.mockLatencyMs;
+        options.jitterMs = config.mockJitterMs;
+        options.accuracy = config.mockAccuracy;
+        options.labelsPath = config.labelsPath;
+        return new MockClassifier(options, parent);
+    }
+    return nullptr;
+}
+
+quint64 Classifier::newRequestId() {
+    return nextRequestId++;
+}
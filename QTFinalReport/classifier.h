@@ -0,0 +1,56 @@
+﻿#ifndef CLASSIFIER_H
+#define CLASSIFIER_H
+
+#include "appconfig.h"
+#include "inferenceengine.h"
+#include <QObject>
+
+// 辨識後端的共同介面，InferenceService 在其上排程、快取並回傳結果
+// 實作：TfliteClassifier（程序內模型）、RemoteClassifier（辨識伺服器）、
+//       FileShareClassifier（images/ + result.txt 的 Python 流程）、MockClassifier（固定結果、可設定延遲）
+// 結果一律以 classified 非同步回傳，不會在 classify() 內直接發出
+class Classifier : public QObject {
+    Q_OBJECT
+
+public:
+    struct ModelInfo {
+        QString backend;                 // tflite、server、fileshare、mock
+        QString description;             // 顯示用：模型檔、推理設定或連線對象
+        QStringList labels;
+        int inputSize = 0;               // 需要的輸入邊長，呼叫端先前處理（0 = 直接送原始畫布）
+        bool hasScores = false;          // 結果含各類別機率（背景辨識提前結束需要）
+        bool writesResultFile = false;   // 辨識端自行追加 result.txt 並搬移圖片（Python 流程）
+        bool cacheable = true;           // 結果只由影像決定，可依 dHash 快取
+        int maxInFlight = 1;             // 可同時等待回覆的正式提交數（辨識伺服器會把它們併成一批）
+    };
+
+    explicit Classifier(QObject *parent = nullptr);
+
+    virtual void start() = 0;   // 非同步載入或連線，完成後發出 ready
+    virtual void reload();      // 重新載入模型；預設不支援
+    virtual bool isReady() const = 0;
+    virtual ModelInfo modelInfo() const = 0;
+
+    // 回傳各張的 requestId；影像的文字欄位 Question（題目）供檔案流程命名與 mock 後端使用
+    virtual QVector<quint64> classifyBatch(const QVector<QImage> &images, const QVector<quint64> &submissionIds) = 0;
+    quint64 classify(const QImage &image, quint64 submissionId = 0);
+
+    // 機率最高的 k 個類別；沒有機率的後端只回傳預測類別
+    static QVector<int> topK(const Prediction &prediction, int k);
+
+    // backend 為 tflite、server、fileshare 或 mock；其他名稱回傳 nullptr
+    static Classifier *create(const QString &backend, const AppConfig &config, QObject *parent = nullptr);
+
+signals:
+    void ready(bool ok, const QString &message);   // 就緒後失去連線也會發出 ready(false)
+    void reloaded(bool ok, const QString &message);
+    void classified(quint64 requestId, const Prediction &prediction);
+
+protected:
+    quint64 newRequestId();
+
+private:
+    quint64 nextRequestId = 1;
+};
+
+#endif // CLASSIFIER_H
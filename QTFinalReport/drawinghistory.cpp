@@ -0,0 +1,107 @@
+﻿#include "drawinghistory.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QTextStream>
+
+namespace DrawingHistory {
+
+namespace {
+QMutex archiveMutex;
+
+// 與 lite.py 相同的「Key: value | Key: value」格式
+QString field(const QStringList &parts, const QString &key) {
+    for (const QString &part : parts) {
+        if (part.section(':', 0, 0).trimmed() == key) {
+            return part.section(':', 1).trimmed();
+        }
+    }
+    return QString();
+}
+}
+
+int archiveRound(const QString &resultFile, const QString &imageDir, const QString &historyDir) {
+    QFile results(resultFile);
+    if (!results.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return 0;
+    }
+    QStringList lines;
+    QTextStream in(&results);
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (!line.isEmpty()) {
+            lines.append(line);
+        }
+    }
+    results.close();
+    if (lines.isEmpty()) {
+        return 0;
+    }
+
+    QMutexLocker locker(&archiveMutex);
+    QFile index(historyDir + "/index.tsv");
+    if (!QDir().mkpath(historyDir) || !index.open(QIODevice::Append | QIODevice::Text)) {
+        return 0;
+    }
+    QTextStream out(&index);
+    int archived = 0;
+    for (const QString &line : lines) {
+        const QStringList parts = line.split('|');
+        const QString imageName = QFileInfo(field(parts, "Image")).fileName();
+        const QString predicted = field(parts, "Predicted Class");
+        if (imageName.isEmpty() || predicted.isEmpty()) {
+            continue;
+        }
+        const QFileInfo image(imageDir + "/" + imageName);
+        if (!image.exists()) {
+            continue;   // 同一題提交多次時只留最後一張
+        }
+
+        const QDateTime time = image.lastModified();
+        const QString dayDir = time.toString("yyyy-MM-dd");
+        const QString relativePath = QString("%1/%2-%3").arg(dayDir, QString::number(time.toMSecsSinceEpoch()), imageName);
+        QDir().mkpath(historyDir + "/" + dayDir);
+        const QString target = historyDir + "/" + relativePath;
+        if (!QFile::rename(image.absoluteFilePath(), target) && !QFile::copy(image.absoluteFilePath(), target)) {
+            continue;   // 不同磁碟時改為複製，原檔由呼叫端清除
+        }
+
+        const QString question = image.completeBaseName();
+        out << time.toMSecsSinceEpoch() << '\t' << question << '\t' << predicted << '\t'
+            << field(parts, "Confidence") << '\t' << (field(parts, "Result") == "yes" ? "yes" : "no") << '\t'
+            << relativePath << '\n';
+        ++archived;
+    }
+    return archived;
+}
+
+QVector<Record> readIndex(const QString &historyDir, QString *error) {
+    QVector<Record> records;
+    QFile index(historyDir + "/index.tsv");
+    if (!index.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error) {
+            *error = "沒有歷史紀錄：" + index.fileName();
+        }
+        return records;
+    }
+    QTextStream in(&index);
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split('\t');
+        if (fields.size() < 6) {
+            continue;
+        }
+        Record record;
+        record.timeMsecs = fields[0].toLongLong();
+        record.question = fields[1];
+        record.predicted = fields[2];
+        record.confidence = fields[3].toFloat();
+        record.correct = fields[4] == "yes";
+        record.imagePath = fields[5];
+        records.append(record);
+    }
+    return records;
+}
+
+} // namespace DrawingHistory
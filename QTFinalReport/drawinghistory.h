@@ -0,0 +1,30 @@
+﻿#ifndef DRAWINGHISTORY_H
+#define DRAWINGHISTORY_H
+
+#include <QString>
+#include <QVector>
+
+// 遊戲站收集到的所有作品：每局結束清除 result.txt 與 resultfile/ 前先歸檔到 historyDir
+//   historyDir/index.tsv          每張一行：時間（epoch 毫秒）、題目、預測類別、信心度、yes/no、圖片相對路徑
+//   historyDir/yyyy-MM-dd/*.png   圖片本身，檔名前綴時間避免同名題目互相覆蓋
+// 只追加不改寫，瀏覽時整份讀入（每張約 60 bytes，數萬張也只需一瞬間）
+namespace DrawingHistory {
+
+struct Record {
+    qint64 timeMsecs = 0;
+    QString question;
+    QString predicted;
+    float confidence = 0.0f;
+    bool correct = false;
+    QString imagePath;   // 相對於 historyDir
+};
+
+// 依 result.txt 的每一行把 imageDir 中的圖片搬進歷史資料夾並追加索引；回傳歸檔的張數
+// 可在背景執行緒呼叫，多個歸檔同時進行時依序寫入
+int archiveRound(const QString &resultFile, const QString &imageDir, const QString &historyDir);
+
+QVector<Record> readIndex(const QString &historyDir, QString *error = nullptr);
+
+} // namespace DrawingHistory
+
+#endif // DRAWINGHISTORY_H
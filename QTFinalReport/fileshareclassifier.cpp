@@ -0,0 +1,191 @@
+﻿#include "fileshareclassifier.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+FileShareClassifier::FileShareClassifier(const AppConfig &config, QObject *parent)
+    : Classifier(parent), config(config), pollTimer(new QTimer(this)) {
+    connect(pollTimer, &QTimer::timeout, this, &FileShareClassifier::pollResults);
+    clock.start();
+}
+
+// 標籤只用來把類別名稱對應到索引；Python 端沒有啟動也無從得知，一律視為就緒
+void FileShareClassifier::start() {
+    labelList = InferenceEngine::loadLabels(config.labelsPath);
+    started = true;
+    QTimer::singleShot(0, this, [this]() {
+        emit ready(true, QString("使用 Python 辨識流程（%1）").arg(config.imageFolderPath()));
+    });
+}
+
+bool FileShareClassifier::isReady() const {
+    return started;
+}
+
+Classifier::ModelInfo FileShareClassifier::modelInfo() const {
+    ModelInfo info;
+    info.backend = "fileshare";
+    info.description = config.imageFolderPath() + " → " + config.resultFilePath();
+    info.labels = labelList;
+    info.writesResultFile = true;
+    return info;
+}
+
+QVector<quint64> FileShareClassifier::classifyBatch(const QVector<QImage> &images, const QVector<quint64> &submissionIds) {
+    QVector<quint64> requestIds;
+    if (pending.isEmpty()) {
+        readOffset = QFileInfo(config.resultFilePath()).size();
+    }
+    QDir().mkpath(config.imageFolderPath());
+    if (startupDoneMs < 0) {
+        startupDoneMs = clock.elapsed() + config.resultPollDelayMs;
+    }
+    for (int i = 0; i < images.size(); ++i) {
+        const quint64 requestId = newRequestId();
+        requestIds.append(requestId);
+
+        QImage image = images[i];
+        if (image.isNull()) {
+            QMetaObject::invokeMethod(this, [this, requestId]() { emit classified(requestId, Prediction()); },
+                                      Qt::QueuedConnection);
+            continue;
+        }
+        const quint64 submissionId = submissionIds.value(i);
+        if (submissionId != 0) {
+            image.setText("SubmissionId", QString::number(submissionId));   // Python 端的追蹤紀錄以此對應
+        }
+        QString baseName = image.text("Question");
+        if (baseName.isEmpty()) {
+            baseName = QString("submission-%1").arg(submissionId ? submissionId : requestId);
+        }
+        pending.append({requestId, baseName + ".png", image, deadlineFromNow()});
+    }
+    writeNext();
+
+    // 啟動時間還沒過就等到那時才開始檢查，之後的提交直接沿用輪詢
+    if (!pending.isEmpty() && !pollTimer->isActive()) {
+        pollTimer->start(int(qMax<qint64>(0, startupDoneMs - clock.elapsed())));
+    }
+    return requestIds;
+}
+
+void FileShareClassifier::pollResults() {
+    pollTimer->setInterval(config.resultPollIntervalMs);
+    readResults();
+    expirePending();
+    writeNext();
+    if (pending.isEmpty()) {
+        pollTimer->stop();
+    }
+}
+
+// 上一張還在 images/（lite.py 寫完結果才搬走圖片）時不寫，留到下次輪詢
+void FileShareClassifier::writeNext() {
+    for (int i = 0; i < pending.size() && imageFolderEmpty(); ++i) {
+        Pending &next = pending[i];
+        if (next.image.isNull()) {
+            continue;   // 已寫出，等待結果
+        }
+        const bool saved = next.image.save(config.imageFolderPath() + "/" + next.fileName, "PNG");
+        next.image = QImage();
+        if (saved) {
+            next.deadlineMs = deadlineFromNow();   // 從寫出的時間起算
+            return;
+        }
+        const quint64 requestId = pending.takeAt(i--).requestId;
+        QMetaObject::invokeMethod(this, [this, requestId]() { emit classified(requestId, Prediction()); },
+                                  Qt::QueuedConnection);
+    }
+}
+
+bool FileShareClassifier::imageFolderEmpty() const {
+    return QDir(config.imageFolderPath()).entryList({"*.png", "*.jpg", "*.jpeg"}, QDir::Files).isEmpty();
+}
+
+// 還在等 Python 啟動時另外加上剩下的啟動時間
+qint64 FileShareClassifier::deadlineFromNow() const {
+    if (config.resultTimeoutMs <= 0) {
+        return 0;
+    }
+    const qint64 now = clock.elapsed();
+    return qMax(now, startupDoneMs) + config.resultTimeoutMs;
+}
+
+// 讀取新增的完整行，依檔名對應等待中的請求；最後一行可能寫到一半，留到下次再讀
+void FileShareClassifier::readResults() {
+    QFile resultFile(config.resultFilePath());
+    if (!resultFile.open(QIODevice::ReadOnly)) {
+        return;   // 文件尚未生成，繼續監視
+    }
+    if (resultFile.size() < readOffset) {
+        readOffset = 0;   // result.txt 被清空（新的一局）
+    }
+    resultFile.seek(readOffset);
+    while (!resultFile.atEnd()) {
+        const QByteArray line = resultFile.readLine();
+        if (!line.endsWith('\n')) {
+            break;
+        }
+        readOffset += line.size();
+
+        QString imageFile;
+        Prediction prediction = parseLine(QString::fromUtf8(line).trimmed(), &imageFile);
+        if (!prediction.label.isEmpty() && !prediction.isValid()) {
+            // 標籤檔沒有的類別依出現順序補上，讓結果仍然有效
+            qWarning().noquote() << "result.txt 的類別不在標籤檔中：" + prediction.label;
+            labelList.append(prediction.label);
+            prediction.classIndex = labelList.size() - 1;
+        }
+        for (int i = 0; i < pending.size(); ++i) {
+            if (pending[i].image.isNull() && pending[i].fileName == imageFile) {
+                const quint64 requestId = pending.takeAt(i).requestId;
+                emit classified(requestId, prediction);
+                break;
+            }
+        }
+    }
+}
+
+// 辨識端沒有執行、漏掉某張圖或 images/ 一直有別的圖片時，等待中的請求不會永遠卡住
+void FileShareClassifier::expirePending() {
+    const qint64 now = clock.elapsed();
+    for (int i = 0; i < pending.size();) {
+        if (pending[i].deadlineMs > 0 && now >= pending[i].deadlineMs) {
+            const Pending expired = pending.takeAt(i);
+            qWarning().noquote() << "等不到辨識結果，以失敗結束：" + expired.fileName;
+            emit classified(expired.requestId, Prediction());
+        } else {
+            ++i;
+        }
+    }
+}
+
+// 「Image: x | Predicted Class: y | Confidence: 0.93 | Result: yes」，之後可能附有 lite.py 的時間戳（epoch 微秒）
+// 不在標籤檔中的類別 classIndex 為 -1，由呼叫端決定如何處理
+Prediction FileShareClassifier::parseLine(const QString &line, QString *imageFile) const {
+    Prediction prediction;
+    for (const QString &field : line.split('|')) {
+        const QString key = field.section(':', 0, 0).trimmed();
+        const QString value = field.section(':', 1).trimmed();
+        if (key == "Image") {
+            *imageFile = value;
+        } else if (key == "Predicted Class") {
+            prediction.label = value.toLower();
+        } else if (key == "Confidence") {
+            prediction.confidence = value.toFloat();
+        } else if (key == "Detected") {
+            prediction.fileVisibleMicros = value.toLongLong();
+        } else if (key == "ScriptStart") {
+            prediction.scriptStartMicros = value.toLongLong();
+        } else if (key == "InferStart") {
+            prediction.startedMicros = value.toLongLong();
+        } else if (key == "InferEnd") {
+            prediction.finishedMicros = value.toLongLong();
+        }
+    }
+    if (!prediction.label.isEmpty()) {
+        prediction.classIndex = labelList.indexOf(prediction.label);
+    }
+    return prediction;
+}
@@ -0,0 +1,52 @@
+﻿#ifndef FILESHARECLASSIFIER_H
+#define FILESHARECLASSIFIER_H
+
+#include "classifier.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+
+// 原本的 Python 流程：圖片存進 images/，由 cv/watch_images.py + lite.py（或 quickdraw-watch）辨識，
+// 結果追加到 result.txt，圖片移到 resultfile/
+// 檔名取自影像的 Question 欄位（lite.py 以檔名判斷對錯），沒有時以提交編號命名
+// lite.py 要求 images/ 只有一張圖，且先寫結果才搬走圖片：一次只寫一張，images/ 清空後才寫下一張
+// 第一次提交後等 resultPollDelayMs（Python 啟動與載入模型）才開始每 resultPollIntervalMs 讀取 result.txt 新增的行，
+// 這段啟動時間只等一次；圖片寫出後再過 resultTimeoutMs 仍沒有結果就以失敗結束
+class FileShareClassifier : public Classifier {
+    Q_OBJECT
+
+public:
+    explicit FileShareClassifier(const AppConfig &config, QObject *parent = nullptr);
+
+    void start() override;
+    bool isReady() const override;
+    ModelInfo modelInfo() const override;
+    QVector<quint64> classifyBatch(const QVector<QImage> &images, const QVector<quint64> &submissionIds) override;
+
+private:
+    struct Pending {
+        quint64 requestId;
+        QString fileName;
+        QImage image;        // 還沒寫進 images/ 的圖片；寫出後清空
+        qint64 deadlineMs;   // clock 的時間，0 = 不限
+    };
+
+    void pollResults();
+    void writeNext();
+    bool imageFolderEmpty() const;
+    qint64 deadlineFromNow() const;
+    void readResults();
+    void expirePending();
+    Prediction parseLine(const QString &line, QString *imageFile) const;
+
+    AppConfig config;
+    QStringList labelList;
+    bool started = false;
+    QVector<Pending> pending;
+    qint64 readOffset = 0;   // result.txt 已讀到的位置，只讀提交之後新增的結果
+    QTimer *pollTimer;
+    QElapsedTimer clock;
+    qint64 startupDoneMs = -1;   // Python 端預計啟動完成的 clock 時間，第一次提交時決定
+};
+
+#endif // FILESHARECLASSIFIER_H
@@ -0,0 +1,64 @@
+# 遊戲主視窗與其相依元件（main.cpp 以外的全部），主程式與 bench/soak 共用
+
+# 辨識後端（classifier/backend）：程序內模型、辨識伺服器、Python 檔案交換流程或 mock，介面見 classifier.h
+
+# 同一台機器上的多個遊戲站共用一份模型：執行 QTFinalReport --server，各站在 quickdraw.ini 設定 inference/server
+# （以 QLocalSocket 連線，只限同一台機器）
+
+QT += network
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/appconfig.cpp \
+    $$PWD/classifier.cpp \
+    $$PWD/drawinghistory.cpp \
+    $$PWD/fileshareclassifier.cpp \
+    $$PWD/historydelegate.cpp \
+    $$PWD/historymodel.cpp \
+    $$PWD/historywindow.cpp \
+    $$PWD/inferenceclient.cpp \
+    $$PWD/inferencescheduler.cpp \
+    $$PWD/inferenceserver.cpp \
+    $$PWD/inferenceservice.cpp \
+    $$PWD/latencystats.cpp \
+    $$PWD/mainwindow.cpp \
+    $$PWD/mockclassifier.cpp \
+    $$PWD/modelfilewatcher.cpp \
+    $$PWD/multiplayerwindow.cpp \
+    $$PWD/playerpanel.cpp \
+    $$PWD/predictioncache.cpp \
+    $$PWD/remoteclassifier.cpp \
+    $$PWD/resourcestats.cpp \
+    $$PWD/tfliteclassifier.cpp \
+    $$PWD/toast.cpp \
+    $$PWD/tracer.cpp
+
+HEADERS += \
+    $$PWD/appconfig.h \
+    $$PWD/classifier.h \
+    $$PWD/drawinghistory.h \
+    $$PWD/fileshareclassifier.h \
+    $$PWD/historydelegate.h \
+    $$PWD/historymodel.h \
+    $$PWD/historywindow.h \
+    $$PWD/inferenceclient.h \
+    $$PWD/inferenceprotocol.h \
+    $$PWD/inferencescheduler.h \
+    $$PWD/inferenceserver.h \
+    $$PWD/inferenceservice.h \
+    $$PWD/latencystats.h \
+    $$PWD/mainwindow.h \
+    $$PWD/mockclassifier.h \
+    $$PWD/modelfilewatcher.h \
+    $$PWD/multiplayerwindow.h \
+    $$PWD/playerpanel.h \
+    $$PWD/predictioncache.h \
+    $$PWD/remoteclassifier.h \
+    $$PWD/resourcestats.h \
+    $$PWD/tfliteclassifier.h \
+    $$PWD/toast.h \
+    $$PWD/tracer.h
+
+include(canvas.pri)
+include(inference.pri)
@@ -0,0 +1,64 @@
+﻿#include "historydelegate.h"
+#include "historymodel.h"
+#include <QPainter>
+
+namespace {
+constexpr int Padding = 6;
+constexpr int TextHeight = 18;
+}
+
+HistoryDelegate::HistoryDelegate(const QSize &thumbnailSize, QObject *parent)
+    : QStyledItemDelegate(parent), thumbnailSize(thumbnailSize) {}
+
+QSize HistoryDelegate::sizeHint(const QStyleOptionViewItem &, const QModelIndex &) const {
+    return QSize(thumbnailSize.width() + 2 * Padding, thumbnailSize.height() + 2 * TextHeight + 3 * Padding);
+}
+
+void HistoryDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+    painter->save();
+    const QRect cell = option.rect.adjusted(2, 2, -2, -2);
+    painter->fillRect(cell, option.state & QStyle::State_Selected ? QColor("#3d5a80") : QColor("#2b2b2b"));
+
+    // 縮圖：取 DecorationRole 時才會排入背景載入
+    const QRect thumbRect(option.rect.topLeft() + QPoint(Padding, Padding), thumbnailSize);
+    const QPixmap thumbnail = index.data(Qt::DecorationRole).value<QPixmap>();
+    if (thumbnail.isNull()) {
+        painter->fillRect(thumbRect, QColor("#444444"));
+    } else {
+        // 縮圖載入時已縮到格子內，置中畫出即可
+        painter->fillRect(thumbRect, Qt::white);
+        QRect target(QPoint(), thumbnail.size().boundedTo(thumbRect.size()));
+        target.moveCenter(thumbRect.center());
+        painter->drawPixmap(target, thumbnail);
+    }
+
+    // 題目與對錯
+    const bool correct = index.data(HistoryModel::CorrectRole).toBool();
+    const QRect titleRect(thumbRect.left(), thumbRect.bottom() + Padding, thumbRect.width(), TextHeight);
+    const QRect badgeRect(titleRect.right() - 44, titleRect.top(), 44, TextHeight);
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(correct ? QColor("green") : QColor("red"));
+    painter->drawRoundedRect(badgeRect, 5, 5);
+
+    QFont font = option.font;
+    font.setBold(true);
+    painter->setFont(font);
+    painter->setPen(Qt::white);
+    painter->drawText(badgeRect, Qt::AlignCenter, correct ? "正確" : "錯誤");
+    painter->drawText(titleRect.adjusted(0, 0, -badgeRect.width() - Padding, 0), Qt::AlignLeft | Qt::AlignVCenter,
+                      option.fontMetrics.elidedText(index.data(HistoryModel::QuestionRole).toString(), Qt::ElideRight,
+                                                    titleRect.width() - badgeRect.width() - Padding));
+
+    // 預測類別與信心度
+    font.setBold(false);
+    painter->setFont(font);
+    painter->setPen(QColor("#bbbbbb"));
+    const QRect detailRect(titleRect.left(), titleRect.bottom() + 1, titleRect.width(), TextHeight);
+    const QString detail = QString("預測：%1（%2）")
+                               .arg(index.data(HistoryModel::PredictedRole).toString(),
+                                    QString::number(index.data(HistoryModel::ConfidenceRole).toFloat(), 'f', 2));
+    painter->drawText(detailRect, Qt::AlignLeft | Qt::AlignVCenter,
+                      option.fontMetrics.elidedText(detail, Qt::ElideRight, detailRect.width()));
+    painter->restore();
+}
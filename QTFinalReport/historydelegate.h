@@ -0,0 +1,22 @@
+﻿#ifndef HISTORYDELEGATE_H
+#define HISTORYDELEGATE_H
+
+#include <QSize>
+#include <QStyledItemDelegate>
+
+// 歷史作品的格子：縮圖、題目、預測類別與信心度、對錯標籤
+// 直接以 QPainter 繪製，不為每一項建立 widget；縮圖還沒載入時先畫灰色底
+class HistoryDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit HistoryDelegate(const QSize &thumbnailSize, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    QSize thumbnailSize;
+};
+
+#endif // HISTORYDELEGATE_H
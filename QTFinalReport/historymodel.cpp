@@ -0,0 +1,242 @@
+﻿#include "historymodel.h"
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <functional>
+
+namespace {
+constexpr int MaxActiveLoads = 2;
+constexpr int MaxPendingLoads = 128;   // 快速捲動時只保留最近的請求，離開畫面的不必載入
+}
+
+HistoryModel::HistoryModel(QObject *parent) : QAbstractListModel(parent) {
+    loader.setMaxThreadCount(MaxActiveLoads);
+    setThumbnailCacheBytes(48 * 1024 * 1024);
+}
+
+HistoryModel::~HistoryModel() {
+    loader.clear();
+    loader.waitForDone();
+}
+
+void HistoryModel::load(const QString &dir) {
+    historyDir = dir;
+    auto *watcher = new QFutureWatcher<QPair<QVector<DrawingHistory::Record>, QString>>(this);
+    connect(watcher, &QFutureWatcher<QPair<QVector<DrawingHistory::Record>, QString>>::finished, this, [this, watcher]() {
+        const auto result = watcher->result();
+        watcher->deleteLater();
+        setRecords(result.first);
+        emit loaded(result.second);
+    });
+    watcher->setFuture(QtConcurrent::run([dir]() {
+        QString error;
+        QVector<DrawingHistory::Record> records = DrawingHistory::readIndex(dir, &error);
+        return qMakePair(records, error);
+    }));
+}
+
+void HistoryModel::setRecords(const QVector<DrawingHistory::Record> &records) {
+    beginResetModel();
+    ++generation;
+    entries.clear();
+    entries.reserve(records.size());
+    questionNames.clear();
+    nameIndex.clear();
+    for (const DrawingHistory::Record &record : records) {
+        entries.append({record.timeMsecs, internName(record.question), internName(record.predicted),
+                        record.confidence, record.correct, record.imagePath});
+    }
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry &a, const Entry &b) { return a.timeMsecs < b.timeMsecs; });
+    thumbnails.clear();
+    queued.clear();
+    pendingLoads.clear();
+    filterRows();
+    endResetModel();
+}
+
+int HistoryModel::internName(const QString &name) {
+    auto it = nameIndex.constFind(name);
+    if (it != nameIndex.constEnd()) {
+        return it.value();
+    }
+    questionNames.append(name);
+    nameIndex.insert(name, questionNames.size() - 1);
+    return questionNames.size() - 1;
+}
+
+void HistoryModel::setFilter(const QString &question, ResultFilter result) {
+    beginResetModel();
+    questionFilter = question;
+    resultFilter = result;
+    filterRows();
+    dropPendingLoads();   // 篩選後畫面上的項目全換了
+    endResetModel();
+}
+
+void HistoryModel::filterRows() {
+    const int question = questionFilter.isEmpty() ? -1 : nameIndex.value(questionFilter, -2);
+    rows.clear();
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        const Entry &entry = entries[i];
+        if (question != -1 && entry.question != question) {
+            continue;
+        }
+        if ((resultFilter == CorrectOnly && !entry.correct) || (resultFilter == WrongOnly && entry.correct)) {
+            continue;
+        }
+        rows.append(i);
+    }
+}
+
+// 尚未開始的載入全部取消；載入中的照常完成並放進快取
+void HistoryModel::dropPendingLoads() {
+    for (int entry : std::as_const(pendingLoads)) {
+        queued.remove(entry);
+    }
+    pendingLoads.clear();
+}
+
+void HistoryModel::setThumbnailSize(const QSize &size) {
+    if (size == thumbnailSize) {
+        return;
+    }
+    thumbnailSize = size;
+    ++generation;
+    thumbnails.clear();
+    queued.clear();
+    pendingLoads.clear();
+    if (!rows.isEmpty()) {
+        emit dataChanged(index(0), index(rows.size() - 1), {Qt::DecorationRole, ThumbnailReadyRole});
+    }
+}
+
+void HistoryModel::setThumbnailCacheBytes(qint64 bytes) {
+    thumbnails.setMaxCost(int(qMax<qint64>(1, bytes / 1024)));
+}
+
+QStringList HistoryModel::questions() const {
+    QStringList names;
+    QVector<bool> seen(questionNames.size(), false);
+    for (const Entry &entry : entries) {
+        if (!seen[entry.question]) {
+            seen[entry.question] = true;
+            names.append(questionNames[entry.question]);
+        }
+    }
+    names.sort();
+    return names;
+}
+
+int HistoryModel::totalCount() const {
+    return entries.size();
+}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
+    const int entryIndex = rows[index.row()];
+    const Entry &entry = entries[entryIndex];
+    switch (role) {
+    case Qt::DisplayRole:
+    case QuestionRole:
+        return questionNames[entry.question];
+    case PredictedRole:
+        return questionNames[entry.predicted];
+    case ConfidenceRole:
+        return entry.confidence;
+    case CorrectRole:
+        return entry.correct;
+    case TimeRole:
+        return QDateTime::fromMSecsSinceEpoch(entry.timeMsecs);
+    case ImagePathRole:
+        return historyDir + "/" + entry.imagePath;
+    case ThumbnailReadyRole:
+        return thumbnails.contains(entryIndex);
+    case Qt::DecorationRole:
+        if (const QPixmap *pixmap = thumbnails.object(entryIndex)) {
+            return *pixmap;
+        }
+        requestThumbnail(entryIndex);   // 只有畫面上的項目會被繪製，因此只載入看得到的
+        return QVariant();
+    case Qt::ToolTipRole:
+        return QString("%1\n題目：%2　預測：%3（%4）")
+            .arg(QDateTime::fromMSecsSinceEpoch(entry.timeMsecs).toString("yyyy-MM-dd HH:mm:ss"),
+                 questionNames[entry.question], questionNames[entry.predicted],
+                 QString::number(entry.confidence, 'f', 2));
+    default:
+        return QVariant();
+    }
+}
+
+void HistoryModel::requestThumbnail(int entry) const {
+    if (queued.contains(entry)) {
+        return;
+    }
+    queued.insert(entry);
+    pendingLoads.append(entry);
+    if (pendingLoads.size() > MaxPendingLoads) {
+        queued.remove(pendingLoads.takeFirst());   // 早已捲離畫面；再次出現時會重新排入
+    }
+    // data() 是 const；載入完成後更新快取並通知 view，都在 GUI 執行緒上
+    const_cast<HistoryModel *>(this)->startThumbnailLoads();
+}
+
+void HistoryModel::startThumbnailLoads() {
+    while (activeLoads < MaxActiveLoads && !pendingLoads.isEmpty()) {
+        const int entry = pendingLoads.takeLast();
+        ++activeLoads;
+
+        auto *watcher = new QFutureWatcher<QImage>(this);
+        const quint64 requestGeneration = generation;
+        connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, entry, requestGeneration]() {
+            const QImage image = watcher->result();
+            watcher->deleteLater();
+            onThumbnailLoaded(entry, requestGeneration, image);
+        });
+
+        // 解碼時直接縮小，不保留原尺寸的影像
+        const QString path = historyDir + "/" + entries[entry].imagePath;
+        const QSize bounds = thumbnailSize;
+        watcher->setFuture(QtConcurrent::run(&loader, [path, bounds]() {
+            QImageReader reader(path);
+            const QSize original = reader.size();
+            if (original.isValid()) {
+                reader.setScaledSize(original.scaled(bounds, Qt::KeepAspectRatio));
+            }
+            return reader.read();
+        }));
+    }
+}
+
+void HistoryModel::onThumbnailLoaded(int entry, quint64 requestGeneration, const QImage &image) {
+    --activeLoads;
+    if (requestGeneration == generation) {
+        queued.remove(entry);
+        // 載入失敗也放一張空白縮圖，避免每次繪製都重試
+        QPixmap pixmap = image.isNull() ? QPixmap(1, 1) : QPixmap::fromImage(image);
+        if (image.isNull()) {
+            pixmap.fill(Qt::transparent);
+        }
+        const int cost = qMax(1, int(qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8 / 1024));
+        thumbnails.insert(entry, new QPixmap(pixmap), cost);
+        const int row = rowForEntry(entry);
+        if (row >= 0) {
+            emit dataChanged(index(row), index(row), {Qt::DecorationRole, ThumbnailReadyRole});
+        }
+    }
+    startThumbnailLoads();
+}
+
+// rows 為遞減排列，二分搜尋
+int HistoryModel::rowForEntry(int entry) const {
+    const auto it = std::lower_bound(rows.cbegin(), rows.cend(), entry, std::greater<int>());
+    return it != rows.cend() && *it == entry ? int(it - rows.cbegin()) : -1;
+}
@@ -0,0 +1,90 @@
+﻿#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include "drawinghistory.h"
+#include <QAbstractListModel>
+#include <QCache>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QThreadPool>
+
+// 歷史作品的清單模型，新的在前
+// 只保存索引（題目與預測類別以編號代替字串），縮圖在第一次被繪製時才於背景執行緒載入，
+// 放在以位元組計算上限的 QCache 裡，捲動數萬張時記憶體仍固定
+// 篩選在模型內以列號對應表完成，不必再套一層 proxy
+class HistoryModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Role {
+        QuestionRole = Qt::UserRole + 1,
+        PredictedRole,
+        ConfidenceRole,
+        CorrectRole,
+        TimeRole,
+        ImagePathRole,
+        ThumbnailReadyRole,   // 縮圖是否已在快取中（未載入時 DecorationRole 會排入載入）
+    };
+
+    enum ResultFilter {
+        AllResults,
+        CorrectOnly,
+        WrongOnly,
+    };
+
+    explicit HistoryModel(QObject *parent = nullptr);
+    ~HistoryModel() override;
+
+    void load(const QString &historyDir);   // 背景讀取 index.tsv，完成後重設模型並發出 loaded
+    void setFilter(const QString &question, ResultFilter result);   // question 為空字串 = 所有題目
+    void setThumbnailSize(const QSize &size);
+    void setThumbnailCacheBytes(qint64 bytes);
+
+    QStringList questions() const;   // 出現過的題目（排序後），供篩選選單使用
+    int totalCount() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+signals:
+    void loaded(const QString &error);
+
+private:
+    struct Entry {
+        qint64 timeMsecs;
+        int question;    // questionNames 的索引
+        int predicted;
+        float confidence;
+        bool correct;
+        QString imagePath;
+    };
+
+    void setRecords(const QVector<DrawingHistory::Record> &records);
+    void filterRows();
+    void dropPendingLoads();
+    int internName(const QString &name);
+    void requestThumbnail(int entry) const;
+    void startThumbnailLoads();
+    void onThumbnailLoaded(int entry, quint64 generation, const QImage &image);
+    int rowForEntry(int entry) const;
+
+    QString historyDir;
+    QVector<Entry> entries;          // 依時間排序，舊的在前
+    QVector<int> rows;               // 目前顯示的列 → entries 索引，遞減（新的在前）
+    QStringList questionNames;
+    QHash<QString, int> nameIndex;
+    QString questionFilter;
+    ResultFilter resultFilter = AllResults;
+    quint64 generation = 0;          // 重新載入後丟棄舊的縮圖結果
+
+    QSize thumbnailSize = QSize(160, 120);
+    // data() 是 const，繪製時才排入的載入請求記在 mutable 成員
+    QCache<int, QPixmap> thumbnails;   // entries 索引 → 縮圖，cost 以 KB 計
+    mutable QSet<int> queued;          // 已排入或載入中的 entries 索引
+    mutable QVector<int> pendingLoads; // 後進先出：最近繪製的項目先載入
+    int activeLoads = 0;
+    QThreadPool loader;
+};
+
+#endif // HISTORYMODEL_H
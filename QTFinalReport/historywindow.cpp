@@ -0,0 +1,93 @@
+﻿#include "historywindow.h"
+#include "historydelegate.h"
+#include "historymodel.h"
+#include <QComboBox>
+#include <QDebug>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QListView>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+namespace {
+const QSize thumbnailSize(160, 120);
+}
+
+HistoryWindow::HistoryWindow(const QString &historyDir, QWidget *parent)
+    : QDialog(parent), historyDir(historyDir) {
+    setObjectName("historyWindow");
+    setWindowTitle("歷史作品");
+    resize(1000, 700);
+
+    model = new HistoryModel(this);
+    model->setThumbnailSize(thumbnailSize);
+
+    view = new QListView(this);
+    view->setViewMode(QListView::IconMode);
+    view->setMovement(QListView::Static);
+    view->setResizeMode(QListView::Adjust);
+    view->setUniformItemSizes(true);          // 不必逐項詢問大小，數萬項也能立即排版
+    view->setLayoutMode(QListView::Batched);
+    view->setBatchSize(500);
+    view->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    view->setSelectionMode(QAbstractItemView::SingleSelection);
+    view->setSpacing(4);
+    view->setItemDelegate(new HistoryDelegate(thumbnailSize, view));
+    view->setModel(model);
+
+    questionFilter = new QComboBox(this);
+    questionFilter->addItem("全部題目", QString());
+    resultFilter = new QComboBox(this);
+    resultFilter->addItem("全部結果", HistoryModel::AllResults);
+    resultFilter->addItem("只看正確", HistoryModel::CorrectOnly);
+    resultFilter->addItem("只看錯誤", HistoryModel::WrongOnly);
+    countLabel = new QLabel("讀取中...", this);
+    auto *reloadButton = new QPushButton("重新整理", this);
+
+    connect(questionFilter, &QComboBox::currentIndexChanged, this, &HistoryWindow::applyFilter);
+    connect(resultFilter, &QComboBox::currentIndexChanged, this, &HistoryWindow::applyFilter);
+    connect(reloadButton, &QPushButton::clicked, this, &HistoryWindow::reload);
+    connect(model, &HistoryModel::loaded, this, [this](const QString &error) {
+        if (!error.isEmpty()) {
+            qDebug().noquote() << error;
+        }
+        // 保留目前選的題目，重新列出選單
+        const QString selected = questionFilter->currentData().toString();
+        questionFilter->blockSignals(true);
+        questionFilter->clear();
+        questionFilter->addItem("全部題目", QString());
+        for (const QString &question : model->questions()) {
+            questionFilter->addItem(question, question);
+        }
+        questionFilter->setCurrentIndex(qMax(0, questionFilter->findData(selected)));
+        questionFilter->blockSignals(false);
+        applyFilter();
+    });
+
+    auto *filters = new QHBoxLayout();
+    filters->addWidget(questionFilter);
+    filters->addWidget(resultFilter);
+    filters->addWidget(countLabel, 1);
+    filters->addWidget(reloadButton);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(filters);
+    layout->addWidget(view);
+
+    reload();
+}
+
+void HistoryWindow::reload() {
+    countLabel->setText("讀取中...");
+    model->load(historyDir);
+}
+
+void HistoryWindow::applyFilter() {
+    model->setFilter(questionFilter->currentData().toString(),
+                     HistoryModel::ResultFilter(resultFilter->currentData().toInt()));
+    updateCount();
+}
+
+void HistoryWindow::updateCount() {
+    countLabel->setText(QString("顯示 %1 / 共 %2 張").arg(model->rowCount()).arg(model->totalCount()));
+}
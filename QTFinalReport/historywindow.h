@@ -0,0 +1,33 @@
+﻿#ifndef HISTORYWINDOW_H
+#define HISTORYWINDOW_H
+
+#include <QDialog>
+
+class HistoryModel;
+class QComboBox;
+class QLabel;
+class QListView;
+
+// 瀏覽遊戲站收集的所有作品（見 DrawingHistory），可依題目或對錯篩選
+// QListView 只繪製畫面上的項目，縮圖由 HistoryModel 在背景載入並快取
+class HistoryWindow : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit HistoryWindow(const QString &historyDir, QWidget *parent = nullptr);
+
+    void reload();   // 重新讀取索引（新的一局歸檔後）
+
+private:
+    void applyFilter();
+    void updateCount();
+
+    QString historyDir;
+    HistoryModel *model;
+    QListView *view;
+    QComboBox *questionFilter;
+    QComboBox *resultFilter;
+    QLabel *countLabel;
+};
+
+#endif // HISTORYWINDOW_H
@@ -0,0 +1,175 @@
+﻿#include "imagefolderwatcher.h"
+#include "latencystats.h"
+#include <QDir>
+#include <QFileInfo>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+ImageFolderWatcher::ImageFolderWatcher(QObject *parent) : QObject(parent) {}
+
+ImageFolderWatcher::~ImageFolderWatcher() {
+    stop();
+}
+
+bool ImageFolderWatcher::start(const QString &folder, const QStringList &suffixes) {
+    stop();
+    this->folder = QDir(folder).absolutePath();
+    this->suffixes.clear();
+    for (const QString &suffix : suffixes) {
+        this->suffixes << suffix.toLower();
+    }
+    if (!QDir().mkpath(this->folder)) {
+        lastError = "無法建立資料夾 " + this->folder;
+        return false;
+    }
+
+    // 掃描到的檔案可能還在寫入（兩種模式都一樣），等大小穩定才通知
+    stabilityTimer = new QTimer(this);
+    stabilityTimer->setInterval(100);
+    connect(stabilityTimer, &QTimer::timeout, this, &ImageFolderWatcher::checkStability);
+
+    if (!startInotify()) {
+        // 沒有 inotify：資料夾一有變動就開始輪詢候選檔案的大小
+        fallback = new QFileSystemWatcher({this->folder}, this);
+        connect(fallback, &QFileSystemWatcher::directoryChanged, this, [this]() {
+            rescan();
+        });
+    }
+    rescan();
+    return true;
+}
+
+void ImageFolderWatcher::stop() {
+#ifdef Q_OS_LINUX
+    if (inotifyFd >= 0) {
+        delete notifier;
+        notifier = nullptr;
+        ::close(inotifyFd);
+        inotifyFd = -1;
+    }
+#endif
+    delete fallback;
+    fallback = nullptr;
+    delete stabilityTimer;
+    stabilityTimer = nullptr;
+    candidates.clear();
+    reported.clear();
+}
+
+QString ImageFolderWatcher::errorString() const {
+    return lastError;
+}
+
+QString ImageFolderWatcher::backendName() const {
+    return inotifyFd >= 0 ? "inotify" : "polling";
+}
+
+// 掃描到的檔案一律先列為候選，等大小與修改時間穩定才通知：
+// 啟動時或 inotify 佇列溢位時的檔案可能正寫到一半，寫完時若收到 IN_CLOSE_WRITE 會直接通知
+void ImageFolderWatcher::rescan() {
+    const QFileInfoList files = QDir(folder).entryInfoList(QDir::Files, QDir::Name);
+    for (const QFileInfo &info : files) {
+        const QString path = info.absoluteFilePath();
+        if (!accepts(info.fileName()) || reported.contains(path)) {
+            continue;
+        }
+        if (!candidates.contains(path)) {
+            candidates.insert(path, Signature());
+        }
+    }
+    if (!candidates.isEmpty() && !stabilityTimer->isActive()) {
+        stabilityTimer->start();
+    }
+}
+
+void ImageFolderWatcher::forget(const QString &path) {
+    reported.remove(QFileInfo(path).absoluteFilePath());
+}
+
+bool ImageFolderWatcher::startInotify() {
+#ifdef Q_OS_LINUX
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        return false;
+    }
+    if (inotify_add_watch(inotifyFd, QFile::encodeName(folder).constData(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        lastError = QString("inotify_add_watch 失敗：%1").arg(std::strerror(errno));
+        ::close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+    notifier = new QSocketNotifier(inotifyFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &ImageFolderWatcher::readInotify);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ImageFolderWatcher::readInotify() {
+#ifdef Q_OS_LINUX
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;) {
+        const ssize_t length = ::read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;   // EAGAIN：這一輪的事件都讀完了
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                rescan();   // 核心佇列溢位，事件有遺失，改以掃描補上
+                continue;
+            }
+            if (event->len == 0 || (event->mask & IN_ISDIR)) {
+                continue;
+            }
+            const QString fileName = QFile::decodeName(event->name);
+            if (accepts(fileName)) {
+                report(folder + "/" + fileName);
+            }
+        }
+    }
+#endif
+}
+
+// 大小與修改時間和上一次掃描相同、且大小不為 0 時才視為寫完
+void ImageFolderWatcher::checkStability() {
+    for (auto it = candidates.begin(); it != candidates.end();) {
+        const QFileInfo info(it.key());
+        if (!info.exists()) {
+            it = candidates.erase(it);
+            continue;
+        }
+        const Signature current{info.size(), info.lastModified()};
+        if (current.size > 0 && current == it.value()) {
+            const QString path = it.key();
+            it = candidates.erase(it);
+            report(path);
+        } else {
+            it.value() = current;
+            ++it;
+        }
+    }
+    if (candidates.isEmpty()) {
+        stabilityTimer->stop();
+    }
+}
+
+bool ImageFolderWatcher::accepts(const QString &fileName) const {
+    return !fileName.startsWith('.') && suffixes.contains(QFileInfo(fileName).suffix().toLower());
+}
+
+void ImageFolderWatcher::report(const QString &path) {
+    candidates.remove(path);   // inotify 確認寫完時不必再等穩定檢查
+    if (reported.contains(path)) {
+        return;
+    }
+    reported.insert(path);
+    emit fileReady(path, SubmissionLatency::nowMicros());
+}
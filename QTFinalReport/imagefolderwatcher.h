@@ -0,0 +1,60 @@
+﻿#ifndef IMAGEFOLDERWATCHER_H
+#define IMAGEFOLDERWATCHER_H
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QStringList>
+#include <QTimer>
+
+// 監視資料夾中「已寫完」的圖片，每個檔案只通知一次
+// Linux 直接使用 inotify 的 IN_CLOSE_WRITE（寫完關檔）與 IN_MOVED_TO（原子性 rename 進來），
+// 不會在檔案寫到一半時觸發；其他平台以 QFileSystemWatcher 得知資料夾變動，
+// 再等大小與修改時間在連續兩次掃描間不變才視為完成
+// 啟動時與 rescan() 會補上資料夾中已存在的檔案（例如佇列滿時留在磁碟上的），同樣要通過穩定檢查
+class ImageFolderWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ImageFolderWatcher(QObject *parent = nullptr);
+    ~ImageFolderWatcher() override;
+
+    bool start(const QString &folder, const QStringList &suffixes = {"png", "jpg", "jpeg"});
+    void stop();
+    QString errorString() const;
+    QString backendName() const;   // "inotify" 或 "polling"
+
+    void rescan();
+    void forget(const QString &path);   // 檔案已被處理（移走或刪除），之後同名的新檔案要再通知
+
+signals:
+    void fileReady(const QString &path, qint64 detectedMicros);
+
+private:
+    struct Signature {
+        qint64 size = -1;
+        QDateTime modified;
+        bool operator==(const Signature &other) const { return size == other.size && modified == other.modified; }
+    };
+
+    bool startInotify();
+    void readInotify();
+    void checkStability();
+    bool accepts(const QString &fileName) const;
+    void report(const QString &path);
+
+    QString folder;
+    QStringList suffixes;
+    QString lastError;
+    QSet<QString> reported;              // 已通知、尚未 forget 的檔案
+    int inotifyFd = -1;
+    QSocketNotifier *notifier = nullptr;
+    QFileSystemWatcher *fallback = nullptr;
+    QTimer *stabilityTimer = nullptr;
+    QHash<QString, Signature> candidates;   // 掃描到、等待大小穩定的檔案
+};
+
+#endif // IMAGEFOLDERWATCHER_H
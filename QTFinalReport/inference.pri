@@ -0,0 +1,21 @@
+# 程序內推理（TensorFlow Lite C API）
+# 預設不連結 TFLite，辨識改走 cv/ 下的 Python 流程
+# 啟用方式：qmake "TFLITE_DIR=C:/libs/tflite"（需含 include/ 與 lib/tensorflowlite_c）
+# tensorflowlite_c 未包含 XNNPACK delegate 時加上 TFLITE_NO_XNNPACK=1
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/inferenceengine.cpp \
+    $$PWD/inferencetuner.cpp
+
+HEADERS += \
+    $$PWD/inferenceengine.h \
+    $$PWD/inferencetuner.h
+
+!isEmpty(TFLITE_DIR) {
+    DEFINES += HAVE_TFLITE
+    INCLUDEPATH += $$TFLITE_DIR/include
+    LIBS += -L$$TFLITE_DIR/lib -ltensorflowlite_c
+    isEmpty(TFLITE_NO_XNNPACK): DEFINES += HAVE_TFLITE_XNNPACK
+}
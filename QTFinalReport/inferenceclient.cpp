@@ -0,0 +1,159 @@
+﻿#include "inferenceclient.h"
+#include "inferenceprotocol.h"
+#include "latencystats.h"
+#include <QDebug>
+#include <QLocalSocket>
+#include <QTimer>
+
+InferenceClient::InferenceClient(QObject *parent)
+    : QObject(parent) {
+    socket = new QLocalSocket(this);
+    connect(socket, &QLocalSocket::readyRead, this, &InferenceClient::onReadyRead);
+    connect(socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError) {
+        if (!helloReceived) {
+            emit connectionFailed(QString("無法連線到辨識伺服器 %1：%2")
+                                      .arg(socket->serverName(), socket->errorString()));
+        }
+    });
+    connect(socket, &QLocalSocket::disconnected, this, [this]() {
+        const bool wasReady = helloReceived;
+        helloReceived = false;
+        readBuffer.clear();
+        failPending();
+        if (wasReady) {
+            emit disconnected();
+        }
+    });
+}
+
+void InferenceClient::connectToServer(const QString &name) {
+    socket->connectToServer(name);
+}
+
+bool InferenceClient::isReady() const {
+    return helloReceived;
+}
+
+QStringList InferenceClient::labels() const {
+    return labelList;
+}
+
+void InferenceClient::setRequestTimeout(int ms) {
+    requestTimeoutMs = qMax(0, ms);
+}
+
+int InferenceClient::maxBatch() const {
+    return serverMaxBatch;
+}
+
+quint64 InferenceClient::classify(const QImage &modelImage, quint64 submissionId) {
+    const quint64 requestId = nextRequestId++;
+    if (!helloReceived) {
+        // 呼叫端拿到 requestId 之後才發出，與正常回覆一樣是非同步的
+        QMetaObject::invokeMethod(this, [this, requestId]() { emit classified(requestId, Prediction(), 0); },
+                                  Qt::QueuedConnection);
+        return requestId;
+    }
+    pending.insert(requestId, SubmissionLatency::nowMicros());
+    if (requestTimeoutMs > 0) {
+        // 伺服器這麼久都沒回覆就視為故障：中斷連線，等待中的請求全部以失敗結束並發出 disconnected
+        QTimer::singleShot(requestTimeoutMs, this, [this, requestId]() {
+            if (pending.contains(requestId)) {
+                qWarning().noquote() << QString("辨識伺服器超過 %1 ms 沒有回覆，中斷連線").arg(requestTimeoutMs);
+                socket->abort();
+            }
+        });
+    }
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(InferenceProtocol::StreamVersion);
+    out << quint8(InferenceProtocol::Classify) << requestId << submissionId
+        << qint32(modelImage.width()) << qint32(modelImage.height()) << InferenceProtocol::packPixels(modelImage);
+    InferenceProtocol::writeFrame(socket, payload);
+    return requestId;
+}
+
+void InferenceClient::requestStats() {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(InferenceProtocol::StreamVersion);
+    out << quint8(InferenceProtocol::StatsRequest);
+    InferenceProtocol::writeFrame(socket, payload);
+}
+
+void InferenceClient::requestReload() {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(InferenceProtocol::StreamVersion);
+    out << quint8(InferenceProtocol::Reload);
+    InferenceProtocol::writeFrame(socket, payload);
+}
+
+void InferenceClient::onReadyRead() {
+    readBuffer += socket->readAll();
+    QByteArray payload;
+    bool corrupt = false;
+    while (InferenceProtocol::takeFrame(readBuffer, &payload, &corrupt)) {
+        handleMessage(payload);
+    }
+    if (corrupt) {
+        socket->abort();
+    }
+}
+
+void InferenceClient::handleMessage(const QByteArray &payload) {
+    QDataStream in(payload);
+    in.setVersion(InferenceProtocol::StreamVersion);
+    quint8 type = 0;
+    in >> type;
+
+    switch (type) {
+    case InferenceProtocol::Hello: {
+        qint32 maxBatch = 0;
+        in >> labelList >> maxBatch;
+        serverMaxBatch = qMax(1, int(maxBatch));
+        if (helloReceived) {
+            emit labelsChanged();
+            break;
+        }
+        helloReceived = true;
+        emit ready();
+        break;
+    }
+    case InferenceProtocol::Result: {
+        quint64 requestId = 0;
+        qint32 classIndex = -1;
+        qint32 batchSize = 0;
+        qint64 queueMicros = 0;
+        qint64 inferenceMicros = 0;
+        Prediction prediction;
+        in >> requestId >> classIndex >> prediction.label >> prediction.confidence >> prediction.scores
+           >> batchSize >> queueMicros >> inferenceMicros;
+        prediction.classIndex = in.status() == QDataStream::Ok ? classIndex : -1;
+
+        // 推理區間以本機時鐘換算：送出時間 + 排隊時間為開始，加上推理時間為結束
+        const qint64 sent = pending.take(requestId);
+        prediction.startedMicros = sent + queueMicros;
+        prediction.finishedMicros = prediction.startedMicros + inferenceMicros;
+        emit classified(requestId, prediction, batchSize);
+        break;
+    }
+    case InferenceProtocol::StatsReply: {
+        QString report;
+        in >> report;
+        emit statsReceived(report);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void InferenceClient::failPending() {
+    const QList<quint64> requestIds = pending.keys();
+    pending.clear();
+    for (quint64 requestId : requestIds) {
+        emit classified(requestId, Prediction(), 0);
+    }
+}
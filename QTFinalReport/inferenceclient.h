@@ -0,0 +1,53 @@
+﻿#ifndef INFERENCECLIENT_H
+#define INFERENCECLIENT_H
+
+#include "inferenceengine.h"
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+class QLocalSocket;
+
+// InferenceServer 的客戶端：連線後收到 Hello（標籤清單）才算就緒
+// classify() 只送出已前處理的 224x224 影像，結果以 classified 非同步回傳
+class InferenceClient : public QObject {
+    Q_OBJECT
+
+public:
+    explicit InferenceClient(QObject *parent = nullptr);
+
+    void connectToServer(const QString &name);
+    bool isReady() const;
+    QStringList labels() const;
+    int maxBatch() const;   // 伺服器的批次上限，由 Hello 告知
+
+    quint64 classify(const QImage &modelImage, quint64 submissionId = 0);   // 回傳 requestId
+    void setRequestTimeout(int ms);   // 任一請求超過時間沒有回覆就視為伺服器故障而中斷連線（0 = 不限）
+    void requestStats();
+    void requestReload();
+
+signals:
+    void ready();
+    void labelsChanged();   // 伺服器換了模型後重送 Hello
+    void connectionFailed(const QString &message);
+    void disconnected();
+    // 斷線（包括逾時而中斷）時等待中的請求會收到無效的 prediction
+    void classified(quint64 requestId, const Prediction &prediction, int batchSize);
+    void statsReceived(const QString &report);
+
+private:
+    void onReadyRead();
+    void handleMessage(const QByteArray &payload);
+    void failPending();
+
+    QLocalSocket *socket;
+    QByteArray readBuffer;
+    QStringList labelList;
+    int serverMaxBatch = 1;
+    int requestTimeoutMs = 0;
+    QHash<quint64, qint64> pending;   // requestId → 送出時間（epoch 微秒）
+    quint64 nextRequestId = 1;
+    bool helloReceived = false;
+};
+
+#endif // INFERENCECLIENT_H
@@ -0,0 +1,325 @@
+﻿#include "inferenceengine.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <numeric>
+
+#ifdef HAVE_TFLITE
+#include <tensorflow/lite/c/c_api.h>
+#endif
+#ifdef HAVE_TFLITE_XNNPACK
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
+#endif
+
+InferenceEngine::InferenceEngine() = default;
+
+InferenceEngine::~InferenceEngine() {
+    unload();
+}
+
+bool InferenceEngine::load(const QString &modelPath, const QString &labelsPath, const Options &options) {
+    unload();
+
+    labelList = loadLabels(labelsPath, &lastError);
+    if (labelList.isEmpty()) {
+        return false;
+    }
+
+#ifdef HAVE_TFLITE
+    model = TfLiteModelCreateFromFile(QFile::encodeName(modelPath).constData());
+    if (!model) {
+        lastError = "無法載入模型：" + modelPath;
+        return false;
+    }
+
+    TfLiteInterpreterOptions *interpreterOptions = TfLiteInterpreterOptionsCreate();
+    TfLiteInterpreterOptionsSetNumThreads(interpreterOptions, qMax(1, options.numThreads));
+    if (options.xnnpack) {
+#ifdef HAVE_TFLITE_XNNPACK
+        TfLiteXNNPackDelegateOptions delegateOptions = TfLiteXNNPackDelegateOptionsDefault();
+        delegateOptions.num_threads = qMax(1, options.numThreads);
+        delegate = TfLiteXNNPackDelegateCreate(&delegateOptions);
+        if (delegate) {
+            TfLiteInterpreterOptionsAddDelegate(interpreterOptions, delegate);
+        }
+#endif
+        if (!delegate) {
+            TfLiteInterpreterOptionsDelete(interpreterOptions);
+            lastError = hasXnnpack() ? "無法建立 XNNPACK delegate" : "此版本未包含 XNNPACK delegate";
+            unload();
+            return false;
+        }
+    }
+    interpreter = TfLiteInterpreterCreate(model, interpreterOptions);
+    TfLiteInterpreterOptionsDelete(interpreterOptions);
+    if (!interpreter) {
+        lastError = "無法建立推理器";
+        unload();
+        return false;
+    }
+
+    if (!ensureBatchSize(1)) {
+        unload();
+        return false;
+    }
+
+    const TfLiteTensor *output = TfLiteInterpreterGetOutputTensor(interpreter, 0);
+    classCount = TfLiteTensorDim(output, TfLiteTensorNumDims(output) - 1);
+    if (classCount != labelList.size()) {
+        lastError = QString("模型輸出 %1 類，但標籤檔有 %2 類").arg(classCount).arg(labelList.size());
+        unload();
+        return false;
+    }
+    lastError.clear();
+    return true;
+#else
+    Q_UNUSED(modelPath);
+    Q_UNUSED(options);
+    lastError = "未啟用 TensorFlow Lite（以 qmake TFLITE_DIR=... 重新編譯）";
+    return false;
+#endif
+}
+
+bool InferenceEngine::isLoaded() const {
+    return interpreter != nullptr;
+}
+
+QString InferenceEngine::errorString() const {
+    return lastError;
+}
+
+QStringList InferenceEngine::labels() const {
+    return labelList;
+}
+
+Prediction InferenceEngine::classify(const QImage &image) {
+    const QVector<Prediction> results = classifyBatch({image});
+    return results.isEmpty() ? Prediction() : results.first();
+}
+
+QVector<Prediction> InferenceEngine::classifyBatch(const QVector<QImage> &images) {
+    QVector<QImage> modelImages;
+    modelImages.reserve(images.size());
+    for (const QImage &image : images) {
+        modelImages.append(preprocess(image));
+    }
+
+    QVector<Prediction> results;
+    if (!setInput(modelImages) || !invoke()) {
+        return results;
+    }
+    const QVector<QVector<float>> scores = outputs();
+    results.reserve(scores.size());
+    for (const QVector<float> &row : scores) {
+        results.append(postprocess(row));
+    }
+    return results;
+}
+
+// 裁切範圍同 ImageOps.fit(image, (224, 224))：置中裁成正方形後縮放；濾波是 Qt 的平滑縮放而非 LANCZOS
+QImage InferenceEngine::preprocess(const QImage &image) {
+    const QImage::Format format = image.format() == QImage::Format_Grayscale8 ? QImage::Format_Grayscale8
+                                                                               : QImage::Format_RGB888;
+    if (image.width() == InputSize && image.height() == InputSize) {
+        return image.convertToFormat(format);
+    }
+    const int side = qMin(image.width(), image.height());
+    const QRect crop((image.width() - side) / 2, (image.height() - side) / 2, side, side);
+    return image.copy(crop)
+        .scaled(InputSize, InputSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+        .convertToFormat(format);
+}
+
+bool InferenceEngine::setInput(const QVector<QImage> &modelImages) {
+    if (!isLoaded() || modelImages.isEmpty() || !ensureBatchSize(modelImages.size())) {
+        return false;
+    }
+
+    const int pixelsPerImage = InputSize * InputSize * 3;
+    inputBuffer.resize(pixelsPerImage * modelImages.size());
+    float *dst = inputBuffer.data();
+    for (const QImage &modelImage : modelImages) {
+        if (modelImage.format() == QImage::Format_Grayscale8) {
+            // 與 PIL 的 convert("RGB") 相同：灰階值複製到三個通道
+            for (int y = 0; y < InputSize; ++y) {
+                const uchar *src = modelImage.constScanLine(y);
+                for (int x = 0; x < InputSize; ++x) {
+                    const float value = src[x] / 127.5f - 1.0f;  // 正規化到 [-1, 1]
+                    *dst++ = value;
+                    *dst++ = value;
+                    *dst++ = value;
+                }
+            }
+            continue;
+        }
+        const QImage rgb = modelImage.format() == QImage::Format_RGB888
+                               ? modelImage : modelImage.convertToFormat(QImage::Format_RGB888);
+        for (int y = 0; y < InputSize; ++y) {
+            const uchar *src = rgb.constScanLine(y);
+            for (int x = 0; x < InputSize * 3; ++x) {
+                *dst++ = src[x] / 127.5f - 1.0f;  // 正規化到 [-1, 1]
+            }
+        }
+    }
+
+#ifdef HAVE_TFLITE
+    TfLiteTensor *input = TfLiteInterpreterGetInputTensor(interpreter, 0);
+    if (TfLiteTensorCopyFromBuffer(input, inputBuffer.constData(), inputBuffer.size() * sizeof(float)) != kTfLiteOk) {
+        lastError = "無法設定模型輸入";
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool InferenceEngine::invoke() {
+#ifdef HAVE_TFLITE
+    if (!isLoaded() || TfLiteInterpreterInvoke(interpreter) != kTfLiteOk) {
+        lastError = "推理失敗";
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+QVector<QVector<float>> InferenceEngine::outputs() const {
+    QVector<QVector<float>> rows;
+#ifdef HAVE_TFLITE
+    if (!isLoaded()) {
+        return rows;
+    }
+    const TfLiteTensor *output = TfLiteInterpreterGetOutputTensor(interpreter, 0);
+    const float *data = static_cast<const float *>(TfLiteTensorData(output));
+    rows.reserve(batchSize);
+    for (int i = 0; i < batchSize; ++i) {
+        rows.append(QVector<float>(data + i * classCount, data + (i + 1) * classCount));
+    }
+#endif
+    return rows;
+}
+
+Prediction InferenceEngine::postprocess(const QVector<float> &scores) const {
+    Prediction prediction;
+    if (scores.isEmpty()) {
+        return prediction;
+    }
+    prediction.classIndex = int(std::max_element(scores.begin(), scores.end()) - scores.begin());
+    prediction.confidence = scores[prediction.classIndex];
+    prediction.label = labelList.value(prediction.classIndex);
+    prediction.scores = scores;
+    return prediction;
+}
+
+QVector<int> InferenceEngine::topK(const QVector<float> &scores, int k) {
+    QVector<int> order(scores.size());
+    std::iota(order.begin(), order.end(), 0);
+    k = qBound(0, k, int(order.size()));
+    std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                      [&scores](int a, int b) { return scores[a] > scores[b]; });
+    order.resize(k);
+    return order;
+}
+
+std::shared_ptr<InferenceEngine> InferenceEngine::loadAndWarmUp(const QString &modelPath, const QString &labelsPath,
+                                                                const Options &options, int warmupRuns,
+                                                                int warmupBatch, QString *errorString) {
+    auto engine = std::make_shared<InferenceEngine>();
+    if (!engine->load(modelPath, labelsPath, options)) {
+        if (errorString) {
+            *errorString = engine->errorString();
+        }
+        return nullptr;
+    }
+    QImage blank(InputSize, InputSize, QImage::Format_RGB888);
+    blank.fill(Qt::white);
+    for (int i = 0; i < warmupRuns; ++i) {
+        engine->classify(blank);
+        if (warmupBatch > 1) {
+            engine->classifyBatch(QVector<QImage>(warmupBatch, blank));
+        }
+    }
+    return engine;
+}
+
+// labels.txt 每行格式為「編號 類別」，與 lite.py 相同只取類別並轉小寫
+QStringList InferenceEngine::loadLabels(const QString &path, QString *errorString) {
+    QStringList labels;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = "無法開啟標籤檔：" + path;
+        }
+        return labels;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        const int space = line.indexOf(' ');
+        labels.append((space >= 0 ? line.mid(space + 1) : line).trimmed().toLower());
+    }
+    if (labels.isEmpty() && errorString) {
+        *errorString = "標籤檔是空的：" + path;
+    }
+    return labels;
+}
+
+bool InferenceEngine::hasXnnpack() {
+#ifdef HAVE_TFLITE_XNNPACK
+    return true;
+#else
+    return false;
+#endif
+}
+
+QString InferenceEngine::Options::describe() const {
+    return QString("%1 執行緒%2").arg(numThreads).arg(xnnpack ? " + XNNPACK" : "");
+}
+
+void InferenceEngine::unload() {
+#ifdef HAVE_TFLITE
+    if (interpreter) {
+        TfLiteInterpreterDelete(interpreter);
+    }
+#ifdef HAVE_TFLITE_XNNPACK
+    if (delegate) {
+        TfLiteXNNPackDelegateDelete(delegate);
+    }
+#endif
+    if (model) {
+        TfLiteModelDelete(model);
+    }
+#endif
+    interpreter = nullptr;
+    delegate = nullptr;
+    model = nullptr;
+    batchSize = 0;
+    classCount = 0;
+}
+
+// 批次大小改變時重新配置張量
+bool InferenceEngine::ensureBatchSize(int size) {
+#ifdef HAVE_TFLITE
+    if (size == batchSize) {
+        return true;
+    }
+    const int dims[4] = {size, InputSize, InputSize, 3};
+    if (TfLiteInterpreterResizeInputTensor(interpreter, 0, dims, 4) != kTfLiteOk
+        || TfLiteInterpreterAllocateTensors(interpreter) != kTfLiteOk) {
+        lastError = QString("無法配置批次大小 %1 的張量").arg(size);
+        batchSize = 0;
+        return false;
+    }
+    batchSize = size;
+    return true;
+#else
+    Q_UNUSED(size);
+    return false;
+#endif
+}
@@ -0,0 +1,93 @@
+﻿#ifndef INFERENCEENGINE_H
+#define INFERENCEENGINE_H
+
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+struct TfLiteModel;
+struct TfLiteInterpreter;
+struct TfLiteDelegate;
+
+// 單次辨識結果
+struct Prediction {
+    int classIndex = -1;
+    QString label;
+    float confidence = 0.0f;
+    QVector<float> scores;    // 每個類別的機率
+    qint64 startedMicros = 0;   // 推理開始／結束時間（epoch 微秒），由呼叫端填入
+    qint64 finishedMicros = 0;
+    qint64 fileVisibleMicros = 0;   // Python 流程：辨識端偵測到圖片、腳本開始的時間（其他後端為 0）
+    qint64 scriptStartMicros = 0;
+    bool cached = false;        // 由 PredictionCache 直接回傳，未執行模型
+    quint64 submissionId = 0;   // 對應的提交編號，由 InferenceService 填入
+
+    bool isValid() const { return classIndex >= 0; }
+};
+
+// 以 TensorFlow Lite C API 在程序內執行 model_unquant.tflite
+// 前處理步驟與 cv/lite.py 相同：置中裁成正方形、縮放到 224x224、正規化到 [-1, 1]
+// 但縮放濾波不同：這裡用 Qt::SmoothTransformation（雙線性／區域平均），lite.py 用 LANCZOS，
+// 畫布的模型緩衝更是直接以 224x224 反鋸齒作畫，筆畫邊緣的像素值與 Python 流程會有些微差異。
+// 兩者的答案一致率尚未量測：同一批圖片以 quickdraw-score 與 lite.py 各跑一次，比對每張的預測類別即可得到
+// 非執行緒安全：同一個實例一次只能由一個執行緒使用
+// 未以 TFLITE_DIR 編譯時 load() 一律失敗，呼叫端應改走 Python 辨識流程
+class InferenceEngine {
+public:
+    static constexpr int InputSize = 224;
+
+    struct Options {
+        int numThreads = 1;
+        bool xnnpack = false;   // 以 XNNPACK delegate 執行支援的運算（需以 HAVE_TFLITE_XNNPACK 編譯）
+
+        QString describe() const;
+    };
+
+    InferenceEngine();
+    ~InferenceEngine();
+
+    bool load(const QString &modelPath, const QString &labelsPath, const Options &options = Options());
+    bool isLoaded() const;
+    QString errorString() const;
+    QStringList labels() const;
+
+    Prediction classify(const QImage &image);
+    QVector<Prediction> classifyBatch(const QVector<QImage> &images);
+
+    // 分階段介面，讓基準測試可以分別計時
+    // 灰階畫布前處理後仍是 224x224 Grayscale8，setInput 填入張量時才展開成三個通道；其他格式轉成 RGB888
+    static QImage preprocess(const QImage &image);
+    bool setInput(const QVector<QImage> &modelImages);
+    bool invoke();
+    QVector<QVector<float>> outputs() const;
+    Prediction postprocess(const QVector<float> &scores) const;
+    static QVector<int> topK(const QVector<float> &scores, int k);
+
+    static QStringList loadLabels(const QString &path, QString *errorString = nullptr);
+
+    // 載入模型後以空白畫布暖機 warmupRuns 次：配置張量、選擇 kernel、讓模型檔載入記憶體
+    // warmupBatch > 1 時每次另外跑一個該大小的批次，批次張量的配置也先走過；失敗時回傳 nullptr
+    static std::shared_ptr<InferenceEngine> loadAndWarmUp(const QString &modelPath, const QString &labelsPath,
+                                                          const Options &options, int warmupRuns,
+                                                          int warmupBatch = 1, QString *errorString = nullptr);
+    static bool hasXnnpack();   // 編譯時是否包含 XNNPACK delegate
+
+private:
+    Q_DISABLE_COPY(InferenceEngine)
+
+    void unload();
+    bool ensureBatchSize(int size);
+
+    TfLiteModel *model = nullptr;
+    TfLiteInterpreter *interpreter = nullptr;
+    TfLiteDelegate *delegate = nullptr;   // 必須比 interpreter 晚釋放
+    QStringList labelList;
+    QString lastError;
+    int batchSize = 0;
+    int classCount = 0;
+    QVector<float> inputBuffer;
+};
+
+#endif // INFERENCEENGINE_H
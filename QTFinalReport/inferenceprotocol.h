@@ -0,0 +1,95 @@
+﻿#ifndef INFERENCEPROTOCOL_H
+#define INFERENCEPROTOCOL_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QImage>
+#include <QIODevice>
+#include <QtEndian>
+#include <cstring>
+
+// 辨識伺服器與客戶端之間的訊息格式（QLocalSocket）
+// 每則訊息 = 4 bytes 大端長度 + QDataStream 內容，內容第一個欄位是 MessageType：
+//   Hello        伺服器 → 客戶端  labels, maxBatch
+//   Classify     客戶端 → 伺服器  requestId, submissionId, 224x224 像素（RGB888，灰階畫布為單通道）
+//   Result       伺服器 → 客戶端  requestId, classIndex, label, confidence, scores, batchSize, queueMicros, inferenceMicros
+//   StatsRequest 客戶端 → 伺服器  （無）
+//   StatsReply   伺服器 → 客戶端  統計文字
+//   Reload       客戶端 → 伺服器  重新載入模型；成功後伺服器向所有客戶端重送 Hello
+namespace InferenceProtocol {
+
+enum MessageType : quint8 {
+    Hello = 1,
+    Classify,
+    Result,
+    StatsRequest,
+    StatsReply,
+    Reload,
+};
+
+constexpr quint32 MaxFrameSize = 16 * 1024 * 1024;
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+inline void writeFrame(QIODevice *device, const QByteArray &payload) {
+    char header[4];
+    qToBigEndian<quint32>(quint32(payload.size()), header);
+    device->write(header, sizeof(header));
+    device->write(payload);
+}
+
+// 從累積的緩衝區取出一則完整訊息；資料不足時回傳 false
+// 長度超過上限時設定 *corrupt，呼叫端應中斷連線
+inline bool takeFrame(QByteArray &buffer, QByteArray *payload, bool *corrupt) {
+    *corrupt = false;
+    if (buffer.size() < 4) {
+        return false;
+    }
+    const quint32 size = qFromBigEndian<quint32>(buffer.constData());
+    if (size > MaxFrameSize) {
+        *corrupt = true;
+        return false;
+    }
+    if (buffer.size() < qsizetype(4 + size)) {
+        return false;
+    }
+    *payload = buffer.mid(4, size);
+    buffer.remove(0, 4 + size);
+    return true;
+}
+
+// 模型輸入只傳原始像素，省去 PNG 編解碼
+// 灰階影像每像素 1 byte，其他轉成 RGB888；接收端由資料長度判斷通道數，舊版客戶端不受影響
+inline QByteArray packPixels(const QImage &modelImage) {
+    const QImage packed = modelImage.format() == QImage::Format_Grayscale8
+                              ? modelImage : modelImage.convertToFormat(QImage::Format_RGB888);
+    const int rowBytes = packed.width() * (packed.format() == QImage::Format_Grayscale8 ? 1 : 3);
+    QByteArray pixels(rowBytes * packed.height(), Qt::Uninitialized);
+    for (int y = 0; y < packed.height(); ++y) {
+        std::memcpy(pixels.data() + y * rowBytes, packed.constScanLine(y), rowBytes);
+    }
+    return pixels;
+}
+
+inline QImage unpackPixels(const QByteArray &pixels, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return QImage();
+    }
+    int channels;
+    if (pixels.size() == qsizetype(width) * height) {
+        channels = 1;
+    } else if (pixels.size() == qsizetype(width) * height * 3) {
+        channels = 3;
+    } else {
+        return QImage();
+    }
+    const int rowBytes = width * channels;
+    QImage image(width, height, channels == 1 ? QImage::Format_Grayscale8 : QImage::Format_RGB888);
+    for (int y = 0; y < height; ++y) {
+        std::memcpy(image.scanLine(y), pixels.constData() + y * rowBytes, rowBytes);
+    }
+    return image;
+}
+
+} // namespace InferenceProtocol
+
+#endif // INFERENCEPROTOCOL_H
@@ -0,0 +1,124 @@
+﻿#include "inferencescheduler.h"
+#include <QStringList>
+#include <algorithm>
+
+void InferenceScheduler::enqueue(Job job) {
+    job.enqueuedMicros = SubmissionLatency::nowMicros();
+    switch (job.priority) {
+    case Final:
+        finals[job.player].enqueue(job);
+        break;
+    case Preview: {
+        QQueue<Job> &queue = previews[job.player];
+        if (!queue.isEmpty()) {
+            ++supersededPreviews;   // 畫布已經變了，舊的預覽不必再跑
+            queue.clear();
+        }
+        queue.enqueue(job);
+        break;
+    }
+    default:
+        background.enqueue(job);
+        break;
+    }
+}
+
+void InferenceScheduler::requeue(const Job &job) {
+    finals[job.player].prepend(job);
+}
+
+bool InferenceScheduler::takeNext(Job *job, bool finalsOnly, const QSet<int> &busyPlayers) {
+    bool taken = takeRoundRobin(finals, lastFinalPlayer, job, busyPlayers);
+    if (!taken && finalsOnly) {
+        return false;
+    }
+    taken = taken || takeRoundRobin(previews, lastPreviewPlayer, job, busyPlayers);
+    if (!taken) {
+        if (background.isEmpty()) {
+            return false;
+        }
+        *job = background.dequeue();
+    }
+    waits[job->priority].record(SubmissionLatency::nowMicros() - job->enqueuedMicros);
+    return true;
+}
+
+// 從上一位玩家的下一位開始，找第一個有排隊、且沒有工作在執行的佇列
+bool InferenceScheduler::takeRoundRobin(QMap<int, QQueue<Job>> &queues, int &lastPlayer, Job *job,
+                                        const QSet<int> &busyPlayers) {
+    const QList<int> players = queues.keys();
+    const int first = int(std::upper_bound(players.begin(), players.end(), lastPlayer) - players.begin());
+    for (int i = 0; i < players.size(); ++i) {
+        const int player = players[(first + i) % players.size()];
+        QQueue<Job> &queue = queues[player];
+        if (!queue.isEmpty() && !busyPlayers.contains(player)) {
+            lastPlayer = player;
+            *job = queue.dequeue();
+            return true;
+        }
+    }
+    return false;
+}
+
+QSet<int> InferenceScheduler::playersWaiting(Priority priority) const {
+    QSet<int> players;
+    const QMap<int, QQueue<Job>> &queues = priority == Final ? finals : previews;
+    for (auto it = queues.cbegin(); it != queues.cend(); ++it) {
+        if (!it.value().isEmpty()) {
+            players.insert(it.key());
+        }
+    }
+    return players;
+}
+
+bool InferenceScheduler::isEmpty() const {
+    return pendingCount(Final) == 0 && pendingCount(Preview) == 0 && background.isEmpty();
+}
+
+int InferenceScheduler::pendingCount(Priority priority) const {
+    if (priority == Background) {
+        return int(background.size());
+    }
+    int count = 0;
+    for (const QQueue<Job> &queue : priority == Final ? finals : previews) {
+        count += int(queue.size());
+    }
+    return count;
+}
+
+void InferenceScheduler::dropPreviews(int player) {
+    previews.remove(player);
+}
+
+void InferenceScheduler::clear() {
+    finals.clear();
+    previews.clear();
+    background.clear();
+}
+
+const char *InferenceScheduler::priorityName(Priority priority) {
+    switch (priority) {
+    case Final:
+        return "final";
+    case Preview:
+        return "preview";
+    default:
+        return "background";
+    }
+}
+
+QString InferenceScheduler::summaryLine() const {
+    QStringList parts;
+    for (int priority = 0; priority < PriorityCount; ++priority) {
+        const LatencyHistogram &wait = waits[priority];
+        if (wait.count() == 0) {
+            continue;
+        }
+        parts << QString("%1 n=%2 wait p50 %3 ms p99 %4 ms max %5 ms")
+                     .arg(priorityName(Priority(priority))).arg(wait.count())
+                     .arg(wait.percentile(50) / 1000.0, 0, 'f', 1).arg(wait.percentile(99) / 1000.0, 0, 'f', 1)
+                     .arg(wait.max() / 1000.0, 0, 'f', 1);
+    }
+    parts << QString("superseded previews %1").arg(supersededPreviews);
+    return "scheduler: " + parts.join(" | ");
+}
@@ -0,0 +1,61 @@
+﻿#ifndef INFERENCESCHEDULER_H
+#define INFERENCESCHEDULER_H
+
+#include "latencystats.h"
+#include <QImage>
+#include <QMap>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <array>
+
+// InferenceService 的排程：決定推理執行緒空下來時下一筆做什麼
+//   Final       正式提交，永遠優先；多位玩家之間輪流
+//   Preview     作畫中的背景辨識，同一位玩家只保留最新一筆（舊的直接丟棄，不回傳結果）；玩家之間輪流
+//   Background  總結頁重新評分等工作，只在沒有 Final 與 Preview 等待、後端也閒置時執行，先進先出
+// 每個類別各自記錄從排入到開始執行的等待時間
+// 只在主執行緒使用，不需要鎖
+class InferenceScheduler {
+public:
+    enum Priority {
+        Final,
+        Preview,
+        Background,
+        PriorityCount
+    };
+
+    struct Job {
+        QImage image;
+        quint64 submissionId = 0;
+        int player = 0;
+        Priority priority = Final;
+        qint64 enqueuedMicros = 0;
+        quint64 sequence = 0;   // InferenceService 指定的正式提交順序，結果依此回傳
+    };
+
+    void enqueue(Job job);
+    void requeue(const Job &job);   // 後端失敗而退回的正式提交，排回這位玩家佇列的最前面
+    // finalsOnly：後端還有工作在執行，只再取正式提交；busyPlayers 的工作先略過（已用完分到的名額）
+    bool takeNext(Job *job, bool finalsOnly = false, const QSet<int> &busyPlayers = QSet<int>());
+    QSet<int> playersWaiting(Priority priority) const;   // 有工作排隊的玩家（Final 或 Preview）
+    bool isEmpty() const;
+    int pendingCount(Priority priority) const;
+    void dropPreviews(int player);   // 正式提交後，這位玩家排隊中的預覽已無意義
+    void clear();
+
+    static const char *priorityName(Priority priority);
+    QString summaryLine() const;
+
+private:
+    bool takeRoundRobin(QMap<int, QQueue<Job>> &queues, int &lastPlayer, Job *job, const QSet<int> &busyPlayers);
+
+    QMap<int, QQueue<Job>> finals;      // 玩家 → 正式提交
+    QMap<int, QQueue<Job>> previews;    // 玩家 → 最新一筆預覽（佇列長度最多 1）
+    QQueue<Job> background;
+    int lastFinalPlayer = -1;
+    int lastPreviewPlayer = -1;
+    std::array<LatencyHistogram, PriorityCount> waits;
+    qint64 supersededPreviews = 0;
+};
+
+#endif // INFERENCESCHEDULER_H
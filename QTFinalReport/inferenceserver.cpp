@@ -0,0 +1,311 @@
+﻿#include "inferenceserver.h"
+#include "inferenceprotocol.h"
+#include "tracer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSet>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+InferenceServer::InferenceServer(QObject *parent)
+    : QObject(parent), engine(std::make_shared<InferenceEngine>()) {
+    worker.setMaxThreadCount(1);
+    worker.setExpiryTimeout(-1);
+
+    server = new QLocalServer(this);
+    connect(server, &QLocalServer::newConnection, this, &InferenceServer::onNewConnection);
+
+    batchTimer = new QTimer(this);
+    batchTimer->setSingleShot(true);
+    batchTimer->setTimerType(Qt::PreciseTimer);   // 等待時間只有幾毫秒，粗略計時器誤差太大
+    connect(batchTimer, &QTimer::timeout, this, &InferenceServer::dispatch);
+
+    statsTimer = new QTimer(this);
+    connect(statsTimer, &QTimer::timeout, this, [this]() { qInfo().noquote() << statsReport(); });
+}
+
+InferenceServer::~InferenceServer() {
+    worker.waitForDone();
+}
+
+bool InferenceServer::start(const AppConfig &appConfig, const Options &serverOptions) {
+    config = appConfig;
+    options = serverOptions;
+    options.maxBatch = qMax(1, options.maxBatch);
+    options.maxWaitMs = qMax(0, options.maxWaitMs);
+    batchSizeCounts.fill(0, options.maxBatch + 1);
+
+    QElapsedTimer timer;
+    timer.start();
+    // 單張與滿批都暖機，兩種張量配置都先走過
+    std::shared_ptr<InferenceEngine> loaded = InferenceEngine::loadAndWarmUp(
+        config.modelPath, config.labelsPath, options.engine, config.warmupRuns, options.maxBatch, &lastError);
+    if (!loaded) {
+        return false;
+    }
+    engine = loaded;
+
+    QLocalServer::removeServer(options.name);   // 清掉上次異常結束留下的 socket 檔
+    if (!server->listen(options.name)) {
+        lastError = QString("無法監聽 %1：%2").arg(options.name, server->errorString());
+        return false;
+    }
+    if (options.statsIntervalMs > 0) {
+        statsTimer->start(options.statsIntervalMs);
+    }
+    if (config.watchModel) {
+        auto *fileWatcher = new ModelFileWatcher({config.modelPath, config.labelsPath}, 1000, this);
+        connect(fileWatcher, &ModelFileWatcher::changed, this, &InferenceServer::reload);
+    }
+    qInfo().noquote() << QString("辨識伺服器已啟動：%1（%2，批次上限 %3，等待上限 %4 ms，啟動 %5 ms）")
+                             .arg(server->fullServerName(), options.engine.describe()).arg(options.maxBatch)
+                             .arg(options.maxWaitMs).arg(timer.elapsed());
+    return true;
+}
+
+QString InferenceServer::errorString() const {
+    return lastError;
+}
+
+QString InferenceServer::statsReport() const {
+    QStringList sizes;
+    for (int size = 1; size < batchSizeCounts.size(); ++size) {
+        if (batchSizeCounts[size] > 0) {
+            sizes << QString("%1×%2").arg(size).arg(batchSizeCounts[size]);
+        }
+    }
+    const double averageBatch = completedBatches ? double(completedRequests) / completedBatches : 0.0;
+    return QString("clients %1 | requests %2 | batches %3 (avg %4; %5) | queue %6 (max %7) | "
+                   "wait p50 %8 ms p99 %9 ms | batch p50 %10 ms p99 %11 ms")
+        .arg(clientCount).arg(requestCount).arg(batchCount).arg(averageBatch, 0, 'f', 2)
+        .arg(sizes.isEmpty() ? QString("-") : sizes.join(' '))
+        .arg(queue.size()).arg(maxQueueDepth)
+        .arg(queueWait.percentile(50) / 1000.0, 0, 'f', 2).arg(queueWait.percentile(99) / 1000.0, 0, 'f', 2)
+        .arg(batchLatency.percentile(50) / 1000.0, 0, 'f', 2).arg(batchLatency.percentile(99) / 1000.0, 0, 'f', 2);
+}
+
+void InferenceServer::onNewConnection() {
+    while (QLocalSocket *client = server->nextPendingConnection()) {
+        ++clientCount;
+        readBuffers.insert(client, QByteArray());
+        connect(client, &QLocalSocket::readyRead, this, [this, client]() { onReadyRead(client); });
+        connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+            --clientCount;
+            readBuffers.remove(client);
+            client->deleteLater();   // 佇列中的請求以 QPointer 持有，斷線後自動略過回覆
+        });
+
+        sendHello(client);
+    }
+}
+
+void InferenceServer::sendHello(QLocalSocket *client) {
+    QByteArray hello;
+    QDataStream out(&hello, QIODevice::WriteOnly);
+    out.setVersion(InferenceProtocol::StreamVersion);
+    out << quint8(InferenceProtocol::Hello) << engine->labels() << qint32(options.maxBatch);
+    InferenceProtocol::writeFrame(client, hello);
+}
+
+// 新模型在全域執行緒池載入與暖機，推理照常進行
+// 已送出的批次持有舊引擎的 shared_ptr，會在舊模型上完成；之後的批次使用新模型
+void InferenceServer::reload() {
+    if (reloading) {
+        reloadPending = true;
+        return;
+    }
+    reloading = true;
+
+    struct LoadResult {
+        std::shared_ptr<InferenceEngine> engine;
+        QString message;
+    };
+    auto *watcher = new QFutureWatcher<LoadResult>(this);
+    connect(watcher, &QFutureWatcher<LoadResult>::finished, this, [this, watcher]() {
+        const LoadResult result = watcher->result();
+        watcher->deleteLater();
+        reloading = false;
+        if (result.engine) {
+            engine = result.engine;
+            qInfo().noquote() << QString("已換用新模型（%1 類）").arg(engine->labels().size());
+            for (QLocalSocket *client : readBuffers.keys()) {
+                sendHello(client);
+            }
+        } else {
+            qWarning().noquote() << "新模型無法載入，繼續使用目前的模型：" + result.message;
+        }
+        if (reloadPending) {
+            reloadPending = false;
+            reload();
+        }
+    });
+
+    const AppConfig loadConfig = config;
+    const int maxBatch = options.maxBatch;
+    const InferenceEngine::Options engineOptions = options.engine;
+    watcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(), [loadConfig, maxBatch, engineOptions]() {
+        LoadResult result;
+        result.engine = InferenceEngine::loadAndWarmUp(loadConfig.modelPath, loadConfig.labelsPath, engineOptions,
+                                                       loadConfig.warmupRuns, maxBatch, &result.message);
+        return result;
+    }));
+}
+
+void InferenceServer::onReadyRead(QLocalSocket *client) {
+    QByteArray &buffer = readBuffers[client];
+    buffer += client->readAll();
+
+    QByteArray payload;
+    bool corrupt = false;
+    while (InferenceProtocol::takeFrame(buffer, &payload, &corrupt)) {
+        handleMessage(client, payload);
+    }
+    if (corrupt) {
+        qWarning() << "辨識伺服器收到過長的訊息，中斷連線";
+        client->abort();
+    }
+}
+
+void InferenceServer::handleMessage(QLocalSocket *client, const QByteArray &payload) {
+    QDataStream in(payload);
+    in.setVersion(InferenceProtocol::StreamVersion);
+    quint8 type = 0;
+    in >> type;
+
+    if (type == InferenceProtocol::StatsRequest) {
+        QByteArray reply;
+        QDataStream out(&reply, QIODevice::WriteOnly);
+        out.setVersion(InferenceProtocol::StreamVersion);
+        out << quint8(InferenceProtocol::StatsReply) << statsReport();
+        InferenceProtocol::writeFrame(client, reply);
+        return;
+    }
+    if (type == InferenceProtocol::Reload) {
+        reload();
+        return;
+    }
+    if (type != InferenceProtocol::Classify) {
+        return;
+    }
+
+    PendingRequest request;
+    request.client = client;
+    qint32 width = 0;
+    qint32 height = 0;
+    QByteArray pixels;
+    in >> request.requestId >> request.submissionId >> width >> height >> pixels;
+    request.image = InferenceProtocol::unpackPixels(pixels, width, height);
+    if (in.status() != QDataStream::Ok || request.image.isNull()) {
+        // 格式錯誤仍要回覆，否則客戶端會一直等
+        sendResults({request}, {Prediction()}, 0, 0);
+        return;
+    }
+    request.enqueuedMicros = SubmissionLatency::nowMicros();
+    enqueue(request);
+}
+
+void InferenceServer::enqueue(PendingRequest request) {
+    ++requestCount;
+    queue.append(std::move(request));
+    maxQueueDepth = qMax(maxQueueDepth, int(queue.size()));
+    reportQueueDepth();
+    scheduleDispatch();
+}
+
+// 推理中就讓佇列繼續累積；閒置時湊滿一批立即送出，否則等最早的請求滿 maxWaitMs
+void InferenceServer::scheduleDispatch() {
+    if (busy || queue.isEmpty()) {
+        return;
+    }
+    const qint64 waitedMs = (SubmissionLatency::nowMicros() - queue.first().enqueuedMicros) / 1000;
+    if (queue.size() >= options.maxBatch || waitedMs >= options.maxWaitMs) {
+        batchTimer->stop();
+        dispatch();
+    } else if (!batchTimer->isActive()) {
+        batchTimer->start(int(options.maxWaitMs - waitedMs));
+    }
+}
+
+void InferenceServer::dispatch() {
+    if (busy || queue.isEmpty()) {
+        return;
+    }
+    // 各客戶端輪流取：每一輪每個遊戲站取最早的一筆，積壓很多請求的遊戲站不會讓其他站等上好幾批
+    QVector<PendingRequest> batch;
+    QVector<bool> taken(queue.size(), false);
+    while (batch.size() < options.maxBatch && batch.size() < queue.size()) {
+        QSet<QLocalSocket *> served;
+        for (int i = 0; i < queue.size() && batch.size() < options.maxBatch; ++i) {
+            QLocalSocket *client = queue[i].client.data();
+            if (taken[i] || served.contains(client)) {
+                continue;
+            }
+            served.insert(client);
+            taken[i] = true;
+            batch.append(queue[i]);
+        }
+    }
+    for (int i = queue.size() - 1; i >= 0; --i) {
+        if (taken[i]) {
+            queue.remove(i);
+        }
+    }
+    const int size = int(batch.size());
+    reportQueueDepth();
+
+    busy = true;
+    ++batchCount;
+    ++batchSizeCounts[size];
+    const qint64 started = SubmissionLatency::nowMicros();
+    QVector<QImage> images;
+    images.reserve(size);
+    for (const PendingRequest &request : batch) {
+        queueWait.record(started - request.enqueuedMicros);
+        images.append(request.image);
+    }
+    Tracer::instance().counter("batch_size", started, size);
+
+    auto *watcher = new QFutureWatcher<QVector<Prediction>>(this);
+    connect(watcher, &QFutureWatcher<QVector<Prediction>>::finished, this, [this, watcher, batch, started]() {
+        const QVector<Prediction> predictions = watcher->result();
+        watcher->deleteLater();
+        const qint64 finished = SubmissionLatency::nowMicros();
+        batchLatency.record(finished - started);
+        completedRequests += batch.size();
+        ++completedBatches;
+        busy = false;
+        sendResults(batch, predictions, started, finished);
+        scheduleDispatch();
+    });
+
+    std::shared_ptr<InferenceEngine> target = engine;
+    watcher->setFuture(QtConcurrent::run(&worker, [target, images]() {
+        TraceSpan span("batch_invoke");
+        return target->classifyBatch(images);
+    }));
+}
+
+void InferenceServer::sendResults(const QVector<PendingRequest> &batch, const QVector<Prediction> &predictions,
+                                  qint64 startedMicros, qint64 finishedMicros) {
+    for (int i = 0; i < batch.size(); ++i) {
+        const PendingRequest &request = batch[i];
+        if (!request.client || request.client->state() != QLocalSocket::ConnectedState) {
+            continue;
+        }
+        const Prediction prediction = predictions.value(i);   // 推理失敗時為無效結果
+        QByteArray reply;
+        QDataStream out(&reply, QIODevice::WriteOnly);
+        out.setVersion(InferenceProtocol::StreamVersion);
+        out << quint8(InferenceProtocol::Result) << request.requestId << qint32(prediction.classIndex)
+            << prediction.label << prediction.confidence << prediction.scores << qint32(batch.size())
+            << qint64(startedMicros - request.enqueuedMicros) << qint64(finishedMicros - startedMicros);
+        InferenceProtocol::writeFrame(request.client, reply);
+    }
+}
+
+void InferenceServer::reportQueueDepth() {
+    Tracer::instance().counter("queue_depth", SubmissionLatency::nowMicros(), queue.size());
+}
@@ -0,0 +1,90 @@
+﻿#ifndef INFERENCESERVER_H
+#define INFERENCESERVER_H
+
+#include "appconfig.h"
+#include "inferenceengine.h"
+#include "latencystats.h"
+#include "modelfilewatcher.h"
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QThreadPool>
+#include <QVector>
+#include <memory>
+
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+
+// 一台機器替多個遊戲站執行模型：以 QLocalServer 接受辨識請求，
+// 同時到達的請求湊成一批（達到 maxBatch 或最早的請求已等待 maxWaitMs 就送出）一起推理，
+// 一批的名額由各客戶端輪流分配
+// 模型檔更新或客戶端要求時在背景載入新模型，載入完成才替換，並向所有客戶端重送標籤
+// 推理在單一背景執行緒進行，事件迴圈持續收請求；同一時間只有一批在推理，下一批在佇列中累積
+class InferenceServer : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString name = "quickdraw-inference";
+        int maxBatch = 8;
+        int maxWaitMs = 4;
+        InferenceEngine::Options engine;   // 執行緒數與 XNNPACK，main 以 TfliteClassifier::engineOptions 決定
+        int statsIntervalMs = 10000;   // 定期輸出統計（0 = 不輸出）
+    };
+
+    explicit InferenceServer(QObject *parent = nullptr);
+    ~InferenceServer() override;
+
+    bool start(const AppConfig &config, const Options &options);  // 載入模型、暖機並開始監聽
+    QString errorString() const;
+    QString statsReport() const;
+    void reload();
+
+private:
+    struct PendingRequest {
+        QPointer<QLocalSocket> client;
+        quint64 requestId = 0;
+        quint64 submissionId = 0;
+        QImage image;
+        qint64 enqueuedMicros = 0;
+    };
+
+    void onNewConnection();
+    void sendHello(QLocalSocket *client);
+    void onReadyRead(QLocalSocket *client);
+    void handleMessage(QLocalSocket *client, const QByteArray &payload);
+    void enqueue(PendingRequest request);
+    void scheduleDispatch();
+    void dispatch();
+    void sendResults(const QVector<PendingRequest> &batch, const QVector<Prediction> &predictions,
+                     qint64 startedMicros, qint64 finishedMicros);
+    void reportQueueDepth();
+
+    QLocalServer *server;
+    QTimer *batchTimer;
+    QTimer *statsTimer;
+    QThreadPool worker;
+    std::shared_ptr<InferenceEngine> engine;
+    AppConfig config;
+    Options options;
+    QString lastError;
+    bool reloading = false;
+    bool reloadPending = false;
+    QHash<QLocalSocket *, QByteArray> readBuffers;
+    QVector<PendingRequest> queue;
+    bool busy = false;
+
+    // 統計
+    int clientCount = 0;
+    int maxQueueDepth = 0;
+    quint64 requestCount = 0;
+    quint64 batchCount = 0;
+    quint64 completedRequests = 0;        // 已推理完成的批次與其張數，平均批次大小不含執行中的那一批
+    quint64 completedBatches = 0;
+    QVector<quint64> batchSizeCounts;     // 索引 = 批次大小
+    LatencyHistogram queueWait;           // 進佇列到開始推理
+    LatencyHistogram batchLatency;        // 一批的推理時間
+};
+
+#endif // INFERENCESERVER_H
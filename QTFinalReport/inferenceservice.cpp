@@ -0,0 +1,350 @@
+﻿#include "inferenceservice.h"
+#include "fileshareclassifier.h"
+#include "latencystats.h"
+#include "tracer.h"
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+InferenceService::InferenceService(QObject *parent) : QObject(parent) {
+    worker.setMaxThreadCount(1);
+    worker.setExpiryTimeout(-1);  // 執行緒常駐，避免每次前處理重新建立
+}
+
+InferenceService::~InferenceService() {
+    worker.waitForDone();
+}
+
+void InferenceService::start(const AppConfig &appConfig) {
+    config = appConfig;
+    QString name = config.classifierBackend;
+    fallbackAllowed = name == "auto";
+    if (fallbackAllowed) {
+        name = config.inferenceServer.isEmpty() ? "tflite" : "server";
+    }
+    Classifier *classifier = Classifier::create(name, config, this);
+    if (!classifier) {
+        failed = true;
+        emit modelReady(false, QString("未知的辨識後端 %1（可用 auto、tflite、server、fileshare、mock）").arg(name));
+        return;
+    }
+    setBackend(classifier);
+}
+
+// 換用新的後端：舊後端上等待中的請求以失敗結束，快取依新後端重建
+void InferenceService::setBackend(Classifier *classifier) {
+    if (backend) {
+        backend->disconnect(this);
+        backend->deleteLater();
+    }
+    backend = classifier;
+    wasReady = false;
+    ++modelGeneration;
+    cache = makeCache();
+    connect(backend, &Classifier::ready, this, &InferenceService::onBackendReady);
+    connect(backend, &Classifier::reloaded, this, [this](bool ok, const QString &message) {
+        if (ok) {
+            // 舊模型的結果不能再用；還在執行的工作以 generation 辨識，回覆時不寫入新的快取
+            ++modelGeneration;
+            cache = makeCache();
+        }
+        emit modelReloaded(ok, message);
+    });
+    connect(backend, &Classifier::classified, this, [this](quint64 requestId, const Prediction &prediction) {
+        const auto it = awaiting.constFind(requestId);
+        if (it == awaiting.constEnd()) {
+            return;
+        }
+        const InFlight done = it.value();
+        awaiting.erase(it);
+        // 後端已不可用（斷線或請求逾時而中斷連線）造成的失敗不是答錯，正式提交留給備援後端重送
+        if (!prediction.isValid() && !backend->isReady()) {
+            retryOrFail(done.job);
+            return;
+        }
+        if (prediction.isValid() && done.generation == modelGeneration) {
+            cache->insert(done.hash, prediction);
+        }
+        finishJob(done.job, prediction);
+    });
+    failInFlight();   // 舊後端不會再回覆
+    backend->start();
+}
+
+// Python 流程的結果由辨識端寫入 result.txt 並搬移圖片，不能以快取略過；
+// 結果不只由影像決定的後端（mock 依題目作答）也不能共用快取
+std::shared_ptr<PredictionCache> InferenceService::makeCache() const {
+    const Classifier::ModelInfo info = backend ? backend->modelInfo() : Classifier::ModelInfo();
+    const bool cacheable = backend && info.cacheable && !info.writesResultFile;
+    return std::make_shared<PredictionCache>(cacheable ? config.cacheCapacity : 0, config.cacheMaxDistance);
+}
+
+void InferenceService::onBackendReady(bool ok, const QString &message) {
+    if (ok) {
+        wasReady = true;
+        failed = false;
+        emit modelReady(true, fallbackReason.isEmpty() ? message : fallbackReason + "：" + message);
+        fallbackReason.clear();
+        runNext();
+        return;
+    }
+
+    const QString backendName = backend->modelInfo().backend;
+    if (fallbackAllowed && backendName != "fileshare") {
+        if (wasReady) {
+            fallbackReason = "與辨識後端的連線中斷";
+        } else {
+            fallbackReason = backendName == "tflite" ? "程序內模型無法使用" : "無法連線到辨識伺服器";
+        }
+        fallbackReason += QString("（%1），改用 Python 辨識流程").arg(message);
+        qWarning().noquote() << fallbackReason;
+        setBackend(new FileShareClassifier(config, this));
+        return;
+    }
+    failed = true;
+    failQueued();
+    emit modelReady(false, message);
+}
+
+void InferenceService::reload() {
+    if (backend && backend->isReady()) {
+        backend->reload();
+    }
+}
+
+bool InferenceService::isReady() const {
+    return backend && backend->isReady();
+}
+
+QStringList InferenceService::labels() const {
+    return isReady() ? backend->modelInfo().labels : QStringList();
+}
+
+Classifier::ModelInfo InferenceService::modelInfo() const {
+    return backend ? backend->modelInfo() : Classifier::ModelInfo();
+}
+
+QString InferenceService::cacheSummary() const {
+    return cache ? cache->summaryLine() : QString();
+}
+
+QString InferenceService::schedulerSummary() const {
+    return scheduler.summaryLine();
+}
+
+void InferenceService::classify(const QImage &image, quint64 submissionId, int player,
+                                InferenceScheduler::Priority priority) {
+    if (failed || !backend) {
+        Prediction failedPrediction;
+        failedPrediction.submissionId = submissionId;
+        emit classified(failedPrediction, player, priority);
+        return;
+    }
+    InferenceScheduler::Job job;
+    job.image = image;
+    job.submissionId = submissionId;
+    job.player = player;
+    job.priority = priority;
+    if (priority == InferenceScheduler::Final) {
+        job.sequence = nextSequence++;
+        finalOrder[player].enqueue(job.sequence);
+    }
+    scheduler.enqueue(job);
+    runNext();
+}
+
+void InferenceService::cancelPreviews(int player) {
+    scheduler.dropPreviews(player);
+}
+
+void InferenceService::failQueued() {
+    InferenceScheduler::Job job;
+    while (scheduler.takeNext(&job)) {
+        deliver(job, Prediction());
+    }
+}
+
+// 依送出順序以失敗結束，呼叫端看到的順序與提交順序相同
+void InferenceService::failInFlight() {
+    QList<quint64> requestIds = awaiting.keys();
+    std::sort(requestIds.begin(), requestIds.end());
+    QList<InFlight> orphaned;
+    for (quint64 requestId : requestIds) {
+        orphaned.append(awaiting.take(requestId));
+    }
+    for (const InFlight &entry : orphaned) {
+        retryOrFail(entry.job);
+    }
+}
+
+int InferenceService::inFlightCount() const {
+    return preparing + int(awaiting.size());
+}
+
+// 後端閒置時取下一筆；後端允許同時處理多筆時（maxInFlight > 1）繼續送出排隊中的正式提交，
+// 預覽與背景工作則要等全部回覆才送，這樣排隊中的工作才能依優先順序重新排列，被取代的預覽也不會先送出去
+// 後端還沒就緒時工作留在佇列，就緒後才開始
+// 同一次取出的工作一起前處理，未命中快取的以 classifyBatch 一次交給後端
+void InferenceService::runNext() {
+    if (!isReady()) {
+        return;
+    }
+    const int capacity = qMax(1, backend->modelInfo().maxInFlight);
+    QVector<InferenceScheduler::Job> jobs;
+    InferenceScheduler::Job job;
+    while (inFlightCount() < capacity
+           && scheduler.takeNext(&job, inFlightCount() > 0, playersAtShare(capacity))) {
+        ++playerInFlight[job.player];
+        ++preparing;
+        jobs.append(job);
+    }
+    if (!jobs.isEmpty()) {
+        dispatch(jobs);
+    }
+}
+
+void InferenceService::dispatch(QVector<InferenceScheduler::Job> jobs) {
+    QVector<QImage> images;
+    QVector<quint64> submissionIds;
+    for (InferenceScheduler::Job &job : jobs) {
+        images.append(job.image);
+        submissionIds.append(job.submissionId);
+        job.image = QImage();   // 圖片已交給背景執行緒，不必再留一份
+    }
+
+    struct Prepared {
+        QImage image;
+        quint64 hash = 0;
+        Prediction cachedPrediction;
+    };
+    auto *watcher = new QFutureWatcher<QVector<Prepared>>(this);
+    Classifier *target = backend;
+    connect(watcher, &QFutureWatcher<QVector<Prepared>>::finished, this, [this, watcher, target, jobs]() {
+        const QVector<Prepared> prepared = watcher->result();
+        watcher->deleteLater();
+        preparing -= int(jobs.size());
+        const bool usable = backend == target && backend->isReady();   // 前處理期間可能換了後端或連線中斷
+
+        QVector<QImage> misses;
+        QVector<quint64> missIds;
+        QVector<int> missIndexes;
+        for (int i = 0; i < jobs.size(); ++i) {
+            if (usable && !prepared[i].cachedPrediction.cached) {
+                misses.append(prepared[i].image);
+                missIds.append(jobs[i].submissionId);
+                missIndexes.append(i);
+            }
+        }
+        if (!misses.isEmpty()) {
+            const QVector<quint64> requestIds = backend->classifyBatch(misses, missIds);
+            for (int k = 0; k < missIndexes.size(); ++k) {
+                const int i = missIndexes[k];
+                InferenceScheduler::Job sent = jobs[i];
+                sent.image = prepared[i].image;
+                awaiting.insert(requestIds.value(k), InFlight{sent, prepared[i].hash, modelGeneration});
+            }
+        }
+        for (int i = 0; i < jobs.size(); ++i) {
+            if (prepared[i].cachedPrediction.cached) {
+                finishJob(jobs[i], prepared[i].cachedPrediction);
+            } else if (!usable) {
+                InferenceScheduler::Job unsent = jobs[i];
+                unsent.image = prepared[i].image;
+                retryOrFail(unsent);
+            }
+        }
+    });
+
+    // 需要固定輸入大小的後端先在這裡前處理，快取的雜湊也以前處理後的影像計算
+    // 畫布的模型緩衝已是輸入大小，前處理只剩格式檢查
+    const int inputSize = backend->modelInfo().inputSize;
+    std::shared_ptr<PredictionCache> sharedCache = cache;
+    watcher->setFuture(QtConcurrent::run(&worker, [sharedCache, images, submissionIds, inputSize]() {
+        QVector<Prepared> results;
+        for (int i = 0; i < images.size(); ++i) {
+            const QImage &image = images[i];
+            const quint64 submissionId = submissionIds[i];
+            const qint64 started = SubmissionLatency::nowMicros();
+            Prepared prepared;
+            prepared.image = image;
+            if (inputSize > 0 && image.size() != QSize(inputSize, inputSize)) {
+                TraceSpan span("preprocess", submissionId);
+                prepared.image = InferenceEngine::preprocess(image);
+                for (const QString &key : image.textKeys()) {
+                    prepared.image.setText(key, image.text(key));
+                }
+            }
+            if (sharedCache->isEnabled()) {
+                TraceSpan span("cache_lookup", submissionId);
+                prepared.hash = PredictionCache::dHash(prepared.image);
+                if (sharedCache->lookup(prepared.hash, &prepared.cachedPrediction)) {
+                    prepared.cachedPrediction.cached = true;
+                    prepared.cachedPrediction.startedMicros = started;
+                    prepared.cachedPrediction.finishedMicros = SubmissionLatency::nowMicros();
+                }
+            }
+            results.append(prepared);
+        }
+        return results;
+    }));
+}
+
+// 後端失敗時正式提交排回佇列，等下一個後端就緒再送；已沒有可用的後端、或是預覽與背景工作就直接以失敗結束
+void InferenceService::retryOrFail(const InferenceScheduler::Job &job) {
+    if (failed || job.priority != InferenceScheduler::Final || job.image.isNull()) {
+        finishJob(job, Prediction());
+        return;
+    }
+    if (--playerInFlight[job.player] <= 0) {
+        playerInFlight.remove(job.player);
+    }
+    scheduler.requeue(job);
+    runNext();   // 後端還沒就緒時不會送出
+}
+
+// 每位有工作（排隊或執行中）的玩家平分後端的名額，至少一筆；只有一位玩家時可用滿
+QSet<int> InferenceService::playersAtShare(int capacity) const {
+    QSet<int> active = scheduler.playersWaiting(InferenceScheduler::Final);
+    for (auto it = playerInFlight.cbegin(); it != playerInFlight.cend(); ++it) {
+        active.insert(it.key());
+    }
+    const int share = qMax(1, capacity / qMax(1, int(active.size())));
+    QSet<int> full;
+    for (auto it = playerInFlight.cbegin(); it != playerInFlight.cend(); ++it) {
+        if (it.value() >= share) {
+            full.insert(it.key());
+        }
+    }
+    return full;
+}
+
+void InferenceService::finishJob(const InferenceScheduler::Job &job, Prediction prediction) {
+    if (--playerInFlight[job.player] <= 0) {
+        playerInFlight.remove(job.player);
+    }
+    deliver(job, prediction);
+    runNext();
+}
+
+// 同一位玩家的正式提交可能同時在執行（快取命中或較小的批次先完成），依提交順序回傳
+void InferenceService::deliver(const InferenceScheduler::Job &job, Prediction prediction) {
+    prediction.submissionId = job.submissionId;
+    if (job.priority != InferenceScheduler::Final) {
+        emit classified(prediction, job.player, job.priority);
+        return;
+    }
+    finishedFinals.insert(job.sequence, prediction);
+    QList<Prediction> ready;
+    QQueue<quint64> &order = finalOrder[job.player];
+    while (!order.isEmpty() && finishedFinals.contains(order.head())) {
+        ready.append(finishedFinals.take(order.dequeue()));
+    }
+    if (order.isEmpty()) {
+        finalOrder.remove(job.player);
+    }
+    // 先整理完再發出：接收端可能立刻提交新的工作
+    for (const Prediction &result : ready) {
+        emit classified(result, job.player, InferenceScheduler::Final);
+    }
+}
@@ -0,0 +1,90 @@
+﻿#ifndef INFERENCESERVICE_H
+#define INFERENCESERVICE_H
+
+#include "appconfig.h"
+#include "classifier.h"
+#include "inferencescheduler.h"
+#include "predictioncache.h"
+#include <QHash>
+#include <QSet>
+#include <QObject>
+#include <QQueue>
+#include <QThreadPool>
+#include <QVector>
+#include <memory>
+
+// 在 Classifier 之上排程、快取並回傳辨識結果，遊戲視窗不必知道實際由哪個後端辨識
+// 後端由 classifier/backend 選擇；auto 時有設定 inference/server 就連線到辨識伺服器，否則載入程序內模型，
+// 無法使用（或連線中斷）時改走 Python 的檔案交換流程
+// 前處理與快取查詢在專用執行緒上，未命中才交給後端
+// 請求依 InferenceScheduler 的優先順序執行：正式提交優先、同一畫布的預覽只做最新的、背景工作只在閒置時做，
+// 多位玩家之間輪流，連續提交的玩家不會讓其他人一直等
+// 後端允許時（辨識伺服器）可同時送出多筆正式提交讓伺服器併批，同一位玩家連續的提交也一樣；
+// 多位玩家同時有工作時平分這些名額，積壓的玩家不會佔滿伺服器的批次；預覽與背景工作一律等後端閒置才送出
+class InferenceService : public QObject {
+    Q_OBJECT
+
+public:
+    explicit InferenceService(QObject *parent = nullptr);
+    ~InferenceService() override;
+
+    void start(const AppConfig &config);   // 非同步啟動後端，完成後發出 modelReady
+    void reload();                          // 重新載入設定中的模型與標籤，完成後發出 modelReloaded
+    bool isReady() const;
+    QStringList labels() const;
+    Classifier::ModelInfo modelInfo() const;
+    QString cacheSummary() const;
+    QString schedulerSummary() const;
+
+    // 不會阻塞；完成後發出 classified，同一位玩家的正式提交依提交順序回傳（先完成的會等前面的）
+    // 被較新預覽取代的預覽不會有結果；影像的 Question 欄位會一併交給後端
+    void classify(const QImage &image, quint64 submissionId = 0, int player = 0,
+                  InferenceScheduler::Priority priority = InferenceScheduler::Final);
+    void cancelPreviews(int player = 0);   // 丟棄尚未執行的預覽（不會有結果）
+
+signals:
+    // 換用備援後端時會再發出一次；之後的提交改由新的後端辨識
+    void modelReady(bool ok, const QString &message);
+    void modelReloaded(bool ok, const QString &message);   // 失敗時仍使用原本的模型
+    void classified(const Prediction &prediction, int player, InferenceScheduler::Priority priority);
+
+private:
+    void setBackend(Classifier *classifier);
+    void onBackendReady(bool ok, const QString &message);
+    void failQueued();
+    void failInFlight();
+    void runNext();
+    void dispatch(QVector<InferenceScheduler::Job> jobs);
+    void finishJob(const InferenceScheduler::Job &job, Prediction prediction);
+    void retryOrFail(const InferenceScheduler::Job &job);
+    void deliver(const InferenceScheduler::Job &job, Prediction prediction);
+    QSet<int> playersAtShare(int capacity) const;
+    int inFlightCount() const;
+    std::shared_ptr<PredictionCache> makeCache() const;
+
+    // 已送給後端、等待回覆的工作；保留前處理後的圖片，後端斷線時交給下一個後端重送
+    struct InFlight {
+        InferenceScheduler::Job job;
+        quint64 hash = 0;
+        quint64 generation = 0;   // 交給後端時的 modelGeneration
+    };
+
+    AppConfig config;
+    QThreadPool worker;
+    Classifier *backend = nullptr;
+    bool fallbackAllowed = false;         // auto：後端無法使用時改走檔案交換流程
+    bool wasReady = false;                // 目前的後端曾經就緒，之後的失敗視為連線中斷
+    bool failed = false;                  // 沒有可用的後端，提交直接回傳失敗
+    QString fallbackReason;
+    InferenceScheduler scheduler;
+    std::shared_ptr<PredictionCache> cache;
+    int preparing = 0;                    // 正在前處理、還沒送出的工作
+    QHash<int, int> playerInFlight;       // 玩家 → 前處理中或等待回覆的工作數
+    quint64 nextSequence = 1;
+    QHash<int, QQueue<quint64>> finalOrder;   // 玩家 → 尚未回傳的正式提交（依提交順序）
+    QHash<quint64, Prediction> finishedFinals;   // 已完成、等前面的提交回傳的結果
+    QHash<quint64, InFlight> awaiting;    // requestId → 等待後端回覆的工作
+    quint64 modelGeneration = 0;          // 換後端或換模型時遞增；送出時的模型已換掉的結果不寫入快取
+};
+
+#endif // INFERENCESERVICE_H
@@ -0,0 +1,114 @@
+﻿#include "inferencetuner.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+
+namespace InferenceTuner {
+
+QVector<InferenceEngine::Options> candidates(bool tuneThreads, bool tuneDelegate, const InferenceEngine::Options &fixed) {
+    QVector<int> threadCounts;
+    if (tuneThreads) {
+        const int cores = qBound(1, QThread::idealThreadCount(), 8);
+        for (int threads = 1; threads < cores; threads *= 2) {
+            threadCounts.append(threads);
+        }
+        threadCounts.append(cores);
+    } else {
+        threadCounts.append(fixed.numThreads);
+    }
+
+    QVector<bool> delegates;
+    if (tuneDelegate && InferenceEngine::hasXnnpack()) {
+        delegates = {false, true};
+    } else {
+        delegates = {tuneDelegate ? false : fixed.xnnpack};
+    }
+
+    QVector<InferenceEngine::Options> result;
+    for (int threads : threadCounts) {
+        for (bool xnnpack : delegates) {
+            InferenceEngine::Options options;
+            options.numThreads = threads;
+            options.xnnpack = xnnpack;
+            result.append(options);
+        }
+    }
+    return result;
+}
+
+QVector<Trial> run(const QString &modelPath, const QString &labelsPath,
+                   const QVector<InferenceEngine::Options> &candidates, int runs) {
+    // 延遲與畫面內容無關，以有筆畫的合成圖代替空白畫布
+    QImage sample(InferenceEngine::InputSize, InferenceEngine::InputSize, QImage::Format_RGB888);
+    sample.fill(Qt::white);
+    for (int i = 0; i < InferenceEngine::InputSize; ++i) {
+        sample.setPixel(i, i, qRgb(0, 0, 0));
+        sample.setPixel(InferenceEngine::InputSize - 1 - i, i, qRgb(0, 0, 0));
+    }
+
+    QVector<Trial> trials;
+    for (const InferenceEngine::Options &options : candidates) {
+        Trial trial;
+        trial.options = options;
+        InferenceEngine engine;
+        if (!engine.load(modelPath, labelsPath, options)) {
+            trial.error = engine.errorString();
+            trials.append(trial);
+            continue;
+        }
+        engine.classify(sample);   // 第一次推理含配置與 kernel 準備，不計入
+        engine.classify(sample);
+
+        QVector<double> samples;
+        QElapsedTimer timer;
+        for (int i = 0; i < qMax(1, runs); ++i) {
+            timer.start();
+            if (!engine.classify(sample).isValid()) {
+                break;
+            }
+            samples.append(timer.nsecsElapsed() / 1e6);
+        }
+        if (samples.isEmpty()) {
+            trial.error = engine.errorString();
+        } else {
+            std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+            trial.medianMs = samples[samples.size() / 2];
+        }
+        trials.append(trial);
+    }
+    return trials;
+}
+
+int fastest(const QVector<Trial> &trials) {
+    int best = -1;
+    for (int i = 0; i < trials.size(); ++i) {
+        if (trials[i].medianMs >= 0 && (best < 0 || trials[i].medianMs < trials[best].medianMs)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+QString signature(const QString &modelPath) {
+    const QFileInfo info(modelPath);
+    return QString("%1|%2|%3|cores=%4|xnnpack=%5")
+        .arg(info.absoluteFilePath(), QString::number(info.size()),
+             QString::number(info.lastModified().toMSecsSinceEpoch()),
+             QString::number(QThread::idealThreadCount()), InferenceEngine::hasXnnpack() ? "1" : "0");
+}
+
+QString report(const QVector<Trial> &trials) {
+    QStringList lines;
+    const int best = fastest(trials);
+    for (int i = 0; i < trials.size(); ++i) {
+        const Trial &trial = trials[i];
+        const QString result = trial.medianMs >= 0 ? QString("%1 ms").arg(trial.medianMs, 0, 'f', 2)
+                                                   : "失敗：" + trial.error;
+        lines << QString("%1 %2  %3").arg(i == best ? "*" : " ", trial.options.describe(), result);
+    }
+    return lines.join('\n');
+}
+
+} // namespace InferenceTuner
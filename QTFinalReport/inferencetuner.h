@@ -0,0 +1,35 @@
+﻿#ifndef INFERENCETUNER_H
+#define INFERENCETUNER_H
+
+#include "inferenceengine.h"
+#include <QString>
+#include <QVector>
+
+// 推理設定的自動調校：在目前的機器上逐一載入候選設定，以單張推理的中位數延遲選出最快者
+// 遊戲在第一次啟動（或模型、CPU 核心數改變）時執行一次，結果存入調校快取（AppConfig::tuningCachePath）
+namespace InferenceTuner {
+
+struct Trial {
+    InferenceEngine::Options options;
+    double medianMs = -1.0;   // 載入失敗時為負值
+    QString error;
+};
+
+// 執行緒數取 1、2、4… 直到核心數（最多 8）；XNNPACK 有編譯進來時每種執行緒數各試開與關
+// tuneThreads / tuneDelegate 為 false 時該項固定使用 fixed 的值
+QVector<InferenceEngine::Options> candidates(bool tuneThreads, bool tuneDelegate, const InferenceEngine::Options &fixed);
+
+QVector<Trial> run(const QString &modelPath, const QString &labelsPath,
+                   const QVector<InferenceEngine::Options> &candidates, int runs = 8);
+
+// 最快的一組；全部失敗時回傳 -1
+int fastest(const QVector<Trial> &trials);
+
+// 模型檔與機器的指紋：任一改變就需要重新調校
+QString signature(const QString &modelPath);
+
+QString report(const QVector<Trial> &trials);
+
+} // namespace InferenceTuner
+
+#endif // INFERENCETUNER_H
@@ -0,0 +1,159 @@
+﻿#include "latencystats.h"
+#include <QStringList>
+#include <QtAlgorithms>
+#include <chrono>
+
+void LatencyHistogram::record(qint64 micros) {
+    micros = qMax<qint64>(0, micros);
+    ++counts[bucketFor(micros)];
+    ++total;
+    sum += micros;
+    maxValue = qMax(maxValue, micros);
+}
+
+void LatencyHistogram::reset() {
+    counts.fill(0);
+    total = 0;
+    sum = 0;
+    maxValue = 0;
+}
+
+// 回傳涵蓋第 p 百分位的格子上界（不超過實際最大值）
+qint64 LatencyHistogram::percentile(double p) const {
+    if (total == 0) {
+        return 0;
+    }
+    const qint64 rank = qMax<qint64>(1, qint64(p / 100.0 * total + 0.5));
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < BucketCount; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return qMin(bucketUpperBound(bucket), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+int LatencyHistogram::bucketFor(qint64 micros) {
+    if (micros < LinearBuckets) {
+        return int(micros);
+    }
+    const int exponent = 63 - int(qCountLeadingZeroBits(quint64(micros)));   // floor(log2)
+    const int sub = int((micros >> (exponent - 3)) & (SubBuckets - 1));
+    const int bucket = LinearBuckets + (exponent - 4) * SubBuckets + sub;
+    return qMin(bucket, BucketCount - 1);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < LinearBuckets) {
+        return bucket;
+    }
+    const int exponent = (bucket - LinearBuckets) / SubBuckets + 4;
+    const int sub = (bucket - LinearBuckets) % SubBuckets;
+    return ((qint64(SubBuckets + sub + 1)) << (exponent - 3)) - 1;
+}
+
+void SubmissionLatency::begin(qint64 epochMicros) {
+    stamps.fill(0);
+    active = true;
+    stamp(SaveStart, epochMicros);
+}
+
+void SubmissionLatency::stamp(Stage stage, qint64 epochMicros) {
+    if (active && epochMicros > 0) {
+        stamps[stage] = epochMicros;
+    }
+}
+
+void SubmissionLatency::finish() {
+    if (!active) {
+        return;
+    }
+    active = false;
+
+    qint64 previous = stamps[SaveStart];
+    for (int stage = SaveStart + 1; stage < StageCount; ++stage) {
+        if (stamps[stage] == 0) {
+            continue;   // 此流程沒有這個階段（例如程序內辨識沒有監看程式）
+        }
+        stageHistograms[stage].record(stamps[stage] - previous);
+        previous = stamps[stage];
+    }
+    totalHistogram.record(previous - stamps[SaveStart]);
+    ++finishedRounds;
+}
+
+void SubmissionLatency::reset() {
+    for (LatencyHistogram &histogram : stageHistograms) {
+        histogram.reset();
+    }
+    totalHistogram.reset();
+    finishedRounds = 0;
+}
+
+QString SubmissionLatency::summaryLine() const {
+    QStringList parts;
+    for (int stage = SaveStart + 1; stage < StageCount; ++stage) {
+        const LatencyHistogram &histogram = stageHistograms[stage];
+        if (histogram.count() == 0) {
+            continue;
+        }
+        parts << QString("%1=%2/%3/%4")
+                     .arg(stageName(Stage(stage)))
+                     .arg(histogram.percentile(50) / 1000.0, 0, 'f', 1)
+                     .arg(histogram.percentile(95) / 1000.0, 0, 'f', 1)
+                     .arg(histogram.percentile(99) / 1000.0, 0, 'f', 1);
+    }
+    return QString("latency n=%1 total=%2/%3/%4 ms (p50/p95/p99) %5")
+        .arg(finishedRounds)
+        .arg(totalHistogram.percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(totalHistogram.percentile(95) / 1000.0, 0, 'f', 1)
+        .arg(totalHistogram.percentile(99) / 1000.0, 0, 'f', 1)
+        .arg(parts.join(' '));
+}
+
+QString SubmissionLatency::report() const {
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5 %6 %7")
+                 .arg("stage", -16).arg("count", 6).arg("mean", 10).arg("p50", 10)
+                 .arg("p95", 10).arg("p99", 10).arg("max", 10);
+    auto row = [&lines](const QString &name, const LatencyHistogram &histogram) {
+        lines << QString("%1 %2 %3 %4 %5 %6 %7")
+                     .arg(name, -16)
+                     .arg(histogram.count(), 6)
+                     .arg(histogram.mean() / 1000.0, 10, 'f', 1)
+                     .arg(histogram.percentile(50) / 1000.0, 10, 'f', 1)
+                     .arg(histogram.percentile(95) / 1000.0, 10, 'f', 1)
+                     .arg(histogram.percentile(99) / 1000.0, 10, 'f', 1)
+                     .arg(histogram.max() / 1000.0, 10, 'f', 1);
+    };
+    for (int stage = SaveStart + 1; stage < StageCount; ++stage) {
+        if (stageHistograms[stage].count() > 0) {
+            row(stageName(Stage(stage)), stageHistograms[stage]);
+        }
+    }
+    row("total", totalHistogram);
+    lines << "（單位：毫秒；每列為「前一個有記錄的階段 → 該階段」的耗時）";
+    return lines.join('\n');
+}
+
+qint64 SubmissionLatency::nowMicros() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+const char *SubmissionLatency::stageName(Stage stage) {
+    switch (stage) {
+    case SaveStart: return "save_start";
+    case EncodeDone: return "encode";
+    case FileWritten: return "write";
+    case FileVisible: return "watcher";
+    case ScriptStart: return "py_spawn";
+    case InferenceStart: return "infer_setup";
+    case InferenceEnd: return "inference";
+    case ResultParsed: return "result_poll";
+    case UiShown: return "ui";
+    case StageCount: break;
+    }
+    return "?";
+}
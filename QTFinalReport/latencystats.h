@@ -0,0 +1,71 @@
+﻿#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QString>
+#include <QtGlobal>
+#include <array>
+
+// 固定記憶體的延遲直方圖（微秒）
+// 0~15 逐一計數，之後每個 2 的次方再分 8 格，百分位數誤差約 12.5% 以內
+class LatencyHistogram {
+public:
+    void record(qint64 micros);
+    void reset();
+
+    qint64 count() const { return total; }
+    qint64 max() const { return maxValue; }
+    double mean() const { return total ? double(sum) / total : 0.0; }
+    qint64 percentile(double p) const;
+
+private:
+    static constexpr int LinearBuckets = 16;
+    static constexpr int SubBuckets = 8;
+    static constexpr int BucketCount = LinearBuckets + 40 * SubBuckets;
+
+    static int bucketFor(qint64 micros);
+    static qint64 bucketUpperBound(int bucket);
+
+    std::array<quint32, BucketCount> counts{};
+    qint64 total = 0;
+    qint64 sum = 0;
+    qint64 maxValue = 0;
+};
+
+// 一次提交從保存到顯示結果的各階段時間戳（epoch 微秒，與 Python 端 time.time_ns() // 1000 對齊）
+// 每個階段的延遲 = 該階段時間戳 − 前一個有記錄的階段時間戳，跨回合累積到直方圖
+class SubmissionLatency {
+public:
+    enum Stage {
+        SaveStart,       // 開始保存畫布
+        EncodeDone,      // PNG 編碼完成
+        FileWritten,     // 檔案寫入完成
+        FileVisible,     // 監看程式看到檔案（Python 流程）
+        ScriptStart,     // lite.py 啟動（Python 流程）
+        InferenceStart,  // 模型開始推理
+        InferenceEnd,    // 模型推理結束
+        ResultParsed,    // 主程式讀到結果
+        UiShown,         // 結果顯示給玩家
+        StageCount
+    };
+
+    void begin(qint64 epochMicros = nowMicros());   // 提交與結果可能交錯，可補記較早的開始時間
+    void stamp(Stage stage, qint64 epochMicros = nowMicros());
+    void finish();      // 結算本次提交，累積到直方圖
+    void reset();
+
+    int rounds() const { return finishedRounds; }
+    QString summaryLine() const;   // 單行 p50/p95/p99（毫秒）
+    QString report() const;        // 每個階段一行的完整報表
+
+    static qint64 nowMicros();
+    static const char *stageName(Stage stage);
+
+private:
+    std::array<qint64, StageCount> stamps{};
+    std::array<LatencyHistogram, StageCount> stageHistograms;
+    LatencyHistogram totalHistogram;
+    int finishedRounds = 0;
+    bool active = false;
+};
+
+#endif // LATENCYSTATS_H
@@ -1,9 +1,167 @@
-﻿#include "mainwindow.h"
-#include <QApplication>
-
-int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
-    MainWindow mainWindow;
-    mainWindow.show();
-    return app.exec();
-}
+﻿#include "mainwindow.h"
+#include "multiplayerwindow.h"
+#include "inferenceclient.h"
+#include "inferenceserver.h"
+#include "inferenceservice.h"
+#include "tfliteclassifier.h"
+#include "historywindow.h"
+#include "strokereplayer.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// 多人模式：QTFinalReport --players 2（2~4 人）
+int playerCount(int argc, char *argv[]) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--players") == 0) {
+            return std::atoi(argv[i + 1]);
+        }
+    }
+    return 1;
+}
+
+bool hasArgument(int argc, char *argv[], const char *name) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 伺服器模式：不開視窗，替同一台機器上的其他遊戲站執行模型（QLocalSocket，不跨機器）
+//   QTFinalReport --server [--listen 名稱] [--max-batch 8] [--max-wait-ms 4] [--threads 4]
+//   QTFinalReport --server-stats [--listen 名稱]   查詢執行中伺服器的佇列與批次統計
+int runServer(QCoreApplication &app) {
+    const AppConfig config = AppConfig::load();
+    InferenceServer::Options options;
+    if (!config.inferenceServer.isEmpty()) {
+        options.name = config.inferenceServer;
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("QuickDraw 辨識伺服器");
+    parser.addHelpOption();
+    parser.addOption({"server", "以伺服器模式執行"});
+    parser.addOption({"server-stats", "查詢伺服器統計後結束"});
+    parser.addOption({"listen", "本機 socket 名稱", "name", options.name});
+    parser.addOption({"max-batch", "一批最多幾張", "count", QString::number(config.serverMaxBatch)});
+    parser.addOption({"max-wait-ms", "湊批次的等待上限", "ms", QString::number(config.serverMaxWaitMs)});
+    parser.addOption({"threads", "推理執行緒數（0 = 依設定或自動調校）", "count", "0"});
+    parser.addOption({"stats-interval-ms", "定期輸出統計的間隔（0 = 不輸出）", "ms", "10000"});
+    parser.process(app);
+    options.name = parser.value("listen");
+
+    if (parser.isSet("server-stats")) {
+        InferenceClient client;
+        QObject::connect(&client, &InferenceClient::ready, &client, [&client]() { client.requestStats(); });
+        QObject::connect(&client, &InferenceClient::statsReceived, &app, [](const QString &report) {
+            qInfo().noquote() << report;
+            QCoreApplication::exit(0);
+        });
+        QObject::connect(&client, &InferenceClient::connectionFailed, &app, [](const QString &message) {
+            qCritical().noquote() << message;
+            QCoreApplication::exit(1);
+        });
+        client.connectToServer(options.name);
+        return app.exec();
+    }
+
+    options.maxBatch = parser.value("max-batch").toInt();
+    options.maxWaitMs = parser.value("max-wait-ms").toInt();
+    QString tuningReport;
+    options.engine = TfliteClassifier::engineOptions(config, &tuningReport);
+    if (!tuningReport.isEmpty()) {
+        qInfo().noquote() << tuningReport;
+    }
+    if (parser.value("threads").toInt() > 0) {
+        options.engine.numThreads = parser.value("threads").toInt();
+    }
+    options.statsIntervalMs = parser.value("stats-interval-ms").toInt();
+
+    InferenceServer server;
+    if (!server.start(config, options)) {
+        qCritical().noquote() << "辨識伺服器無法啟動：" + server.errorString();
+        return 1;
+    }
+    return app.exec();
+}
+
+// 重播模式：依序重播錄製檔中的每一題，播完從頭再來，可當作待機畫面
+//   QTFinalReport --replay 2026-10-19.qdsr [--speed 2]（--speed 0 立即畫完並停在最後一題）
+int runReplay(QApplication &app) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("QuickDraw 筆畫重播");
+    parser.addHelpOption();
+    parser.addOption({"replay", "錄製檔（.qdsr）", "file"});
+    parser.addOption({"speed", "播放速度倍率（0 = 立即畫完）", "factor", "1"});
+    parser.process(app);
+
+    QString error;
+    const QVector<StrokeRecording> recordings = StrokeRecording::readAll(parser.value("replay"), &error);
+    if (recordings.isEmpty()) {
+        qCritical().noquote() << "沒有可重播的筆畫：" + (error.isEmpty() ? parser.value("replay") : error);
+        return 1;
+    }
+    const double speed = qMax(0.0, parser.value("speed").toDouble());
+
+    Canvas canvas;
+    canvas.setCanvasSize(recordings.first().canvasSize.isValid() ? recordings.first().canvasSize : canvas.size());
+    StrokeReplayer replayer(&canvas);
+    int current = 0;
+    const auto playCurrent = [&]() {
+        const StrokeRecording &recording = recordings[current];
+        canvas.setWindowTitle(QString("%1（%2/%3）").arg(recording.label).arg(current + 1).arg(recordings.size()));
+        replayer.play(recording, speed);
+    };
+    // 立即畫完時每題仍停留一下再換下一題，畫完最後一題就停住
+    QObject::connect(&replayer, &StrokeReplayer::finished, &canvas, [&]() {
+        if (speed <= 0 && current + 1 >= recordings.size()) {
+            return;
+        }
+        current = (current + 1) % recordings.size();
+        QTimer::singleShot(1500, &canvas, playCurrent);   // 每題之間停留一下
+    });
+    canvas.show();
+    playCurrent();
+    return app.exec();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    // 伺服器模式不需要視窗系統，可在沒有桌面的機器上執行
+    if (hasArgument(argc, argv, "--server") || hasArgument(argc, argv, "--server-stats")) {
+        QCoreApplication app(argc, argv);
+        return runServer(app);
+    }
+
+    QApplication app(argc, argv);
+    if (hasArgument(argc, argv, "--replay")) {
+        return runReplay(app);
+    }
+    // 管理者瀏覽歷史作品：QTFinalReport --history
+    if (hasArgument(argc, argv, "--history")) {
+        const QString historyDir = AppConfig::load().historyDir;
+        if (historyDir.isEmpty()) {
+            qWarning() << "設定檔沒有指定 paths/history，沒有歸檔可瀏覽";
+            return 1;
+        }
+        HistoryWindow window(historyDir);
+        window.show();
+        return app.exec();
+    }
+    const int players = playerCount(argc, argv);
+    if (players > 1) {
+        MultiplayerWindow window(players);
+        window.showMaximized();
+        return app.exec();
+    }
+    MainWindow mainWindow;
+    mainWindow.show();
+    return app.exec();
+}
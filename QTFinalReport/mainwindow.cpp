@@ -1,561 +1,994 @@
-﻿#include "mainwindow.h"
-
-Canvas::Canvas(QWidget *parent) : QWidget(parent), drawing(false) {
-    setFixedSize(900, 600); // 畫布大小
-    pixmap = QPixmap(size());
-    pixmap.fill(Qt::white);
-    brushColor = Qt::black;
-    brushSize = 5;
-}
-
-void Canvas::setBrushColor(const QColor &color) {
-    brushColor = color;
-}
-
-void Canvas::setBrushSize(int size) {
-    brushSize = size;
-}
-
-void Canvas::setEraser() {
-    brushColor = Qt::white;
-}
-
-QPixmap Canvas::getPixmap() const {
-    return pixmap;
-}
-
-void Canvas::mousePressEvent(QMouseEvent *event) {
-    if (event->button() == Qt::LeftButton) {
-        drawing = true;
-        lastPos = event->pos();
-    }
-}
-
-void Canvas::mouseMoveEvent(QMouseEvent *event) {
-    if (drawing && event->buttons() & Qt::LeftButton) {
-        QPainter painter(&pixmap);
-        QPen pen(brushColor, brushSize, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
-        painter.setPen(pen);
-        painter.drawLine(lastPos, event->pos());
-        lastPos = event->pos();
-        update();
-    }
-}
-
-void Canvas::mouseReleaseEvent(QMouseEvent *event) {
-    if (event->button() == Qt::LeftButton) {
-        drawing = false;
-    }
-}
-
-void Canvas::paintEvent(QPaintEvent *) {
-    QPainter painter(this);
-    painter.drawPixmap(0, 0, pixmap);
-}
-
-void Canvas::clearCanvas() {
-    pixmap.fill(Qt::white); // 填充白色
-    update(); // 更新畫布
-}
-
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), resultFilePath("C:/Users/jason/Desktop/py_quickDraw_ndjson2img/py_quickDraw_ndjson2img/result.txt") {
-
-    // 初始化文件監視定時器
-    fileCheckTimer = new QTimer(this);
-    connect(fileCheckTimer, &QTimer::timeout, this, &MainWindow::monitorResultFile);
-
-    // 初始化計時器
-    questionTimer = new QTimer(this);
-    connect(questionTimer, &QTimer::timeout, this, &MainWindow::updateTimer);
-    // 初始化倒計時顯示
-    timeLabel = new QLabel("倒數時間：30", this);
-    timeLabel->setAlignment(Qt::AlignCenter);
-    timeLabel->setStyleSheet("font-size: 30px; color: white;");
-    timeLabel->hide(); // 開始遊戲前隱藏
-
-    // 初始化題目池
-    questionPool = {"airplane", "bus", "cat", "clock", "fish", "flower", "key", "spider", "star", "tree"};
-    currentQuestionIndex = 0;
-
-    // 初始化畫布
-    canvas = new Canvas(this);
-    canvas->hide(); // 一開始隱藏畫布
-
-    // 初始化主要佈局
-    mainLayout = new QVBoxLayout();
-    controls = new QHBoxLayout();
-
-    // 顯示題目的標籤
-    questionLabel = new QLabel("題目：", this);
-    questionLabel->setAlignment(Qt::AlignCenter);
-
-    // 設置字體大小並加粗
-    QFont font = questionLabel->font();
-    font.setPointSize(30);  // 設置字體大小為 20
-    font.setBold(true);     // 設置字體加粗
-    questionLabel->setFont(font);
-
-    questionLabel->hide(); // 開始遊戲前隱藏
-
-
-    // 調色盤按鈕
-    auto *colorButton = new QPushButton("調色盤");
-    colorButton->setStyleSheet("QPushButton {"
-                              "border: 2px solid white;"   // 白色邊框
-                              "background-color: yellow;"  // 黃色背景
-                              "color: black;"              // 黑色文字
-                              "font-size: 20px;"           // 文字大小
-                              "padding: 5px 10px;"         // 按鈕內邊距
-                              "border-radius: 5px;"        // 圓角邊框
-                              "}");
-    connect(colorButton, &QPushButton::clicked, this, &MainWindow::chooseColor);
-    controls->addWidget(colorButton);
-    colorButton->hide(); // 開始遊戲前隱藏
-
-    // 粗細調節滑塊
-    auto *sizeLabel = new QLabel("粗細: 5");
-    auto *sizeSlider = new QSlider(Qt::Horizontal);
-    sizeSlider->setRange(1, 30);
-    sizeSlider->setValue(5);
-
-    // 設置字體大小並加粗
-    QFont fontsize = sizeLabel->font();
-    fontsize.setPointSize(18);  // 設置字體大小為 18
-    sizeLabel->setFont(fontsize);
-
-    connect(sizeSlider, &QSlider::valueChanged, [this, sizeLabel](int value) {
-        sizeLabel->setText("粗細: " + QString::number(value));
-        canvas->setBrushSize(value);
-    });
-
-    controls->addWidget(sizeLabel);
-    controls->addWidget(sizeSlider);
-
-    // 開始遊戲前隱藏滑塊和顯示的標籤
-    sizeLabel->hide();
-    sizeSlider->hide();
-
-
-    // 保存按鈕
-    auto *saveButton = new QPushButton("保存");
-    saveButton->setStyleSheet("QPushButton {"
-                              "border: 2px solid white;"   // 白色邊框
-                              "background-color: yellow;"  // 黃色背景
-                              "color: black;"              // 黑色文字
-                              "font-size: 20px;"           // 文字大小
-                              "padding: 5px 10px;"         // 按鈕內邊距
-                              "border-radius: 5px;"        // 圓角邊框
-                              "}");
-    connect(saveButton, &QPushButton::clicked, this, &MainWindow::saveCanvas);
-    controls->addWidget(saveButton);
-    saveButton->hide();
-
-    // 清除畫布按鈕
-    auto *clearButton = new QPushButton("清除畫布");
-    clearButton->setStyleSheet("QPushButton {"
-                               "border: 2px solid white;"   // 白色邊框
-                               "background-color: yellow;"  // 黃色背景
-                               "color: black;"              // 黑色文字
-                               "font-size: 20px;"           // 文字大小
-                               "padding: 5px 10px;"         // 按鈕內邊距
-                               "border-radius: 5px;"        // 圓角邊框
-                               "}");
-    connect(clearButton, &QPushButton::clicked, canvas, &Canvas::clearCanvas);
-    controls->addWidget(clearButton);
-    clearButton->hide();
-
-    // 開始遊戲按鈕
-    startButton = new QPushButton("開始遊戲", this);
-    startButton->setStyleSheet("QPushButton {"
-                               "border: 2px solid white;"   // 白色邊框
-                               "background-color: yellow;"  // 黃色背景
-                               "color: black;"              // 黑色文字
-                               "font-size: 80px;"           // 文字大小
-                               "padding: 5px 10px;"         // 按鈕內邊距
-                               "border-radius: 5px;"        // 圓角邊框
-                               "}");
-    connect(startButton, &QPushButton::clicked, this, &MainWindow::startGame);
-
-
-    // 佈局
-    auto *centralWidget = new QWidget();
-    auto *layout = new QVBoxLayout();
-     layout->addWidget(timeLabel); // 添加倒計時顯示
-    layout->addWidget(questionLabel);
-    layout->addWidget(canvas, 0, Qt::AlignCenter);
-    layout->addLayout(controls);
-    layout->addWidget(startButton, 0, Qt::AlignCenter);
-    centralWidget->setLayout(layout);
-    setCentralWidget(centralWidget);
-
-    setWindowTitle("小畫家");
-    resize(800, 600);
-}
-
-
-MainWindow::~MainWindow() = default;
-
-
-void MainWindow::startGame() {
-    qDebug() << "startGame called";
-    // 隱藏開始遊戲按鈕
-    startButton->hide();
-
-    // 隨機排列6個題目
-    std::random_device rd; // 用於生成隨機種子
-    std::mt19937 g(rd()); // Mersenne Twister 隨機數生成器
-    std::shuffle(questionPool.begin(), questionPool.end(), g);
-    questionQueue = questionPool.mid(0, 6); // 取前6個題目
-
-    // 顯示畫布
-    canvas->show();
-
-    // 顯式顯示每個控件
-    for (int i = 0; i < controls->count(); ++i) {
-        QWidget *widget = controls->itemAt(i)->widget();
-        if (widget) {
-            widget->show();
-        }
-    }
-
-    // 更新佈局
-    update();
-
-    // 初始化索引並顯示第一題
-    currentQuestionIndex = 0;
-    showNextQuestion();
-}
-
-
-
-void MainWindow::showNextQuestion() {
-    // 如果所有題目完成，顯示總結
-    if (currentQuestionIndex >= questionQueue.size()) {
-        QMessageBox::information(this, "遊戲結束", "所有題目完成！");
-        showSummary(); // 顯示總結視窗
-        return;
-    }
-
-
-    // 更新當前題目
-    currentQuestion = questionQueue[currentQuestionIndex];
-    questionLabel->setText("題目：" + currentQuestion);
-    questionLabel->show();
-
-    // 清空畫布
-    canvas->clearCanvas();
-    canvas->show();
-
-    // 重置倒計時
-    remainingTime = questionTimeLimit;
-    timeLabel->setText(QString("倒數時間：%1").arg(remainingTime));
-    timeLabel->show();
-
-    // 啟動計時器
-    questionTimer->start(1000); // 每秒觸發一次
-
-    // 增加索引
-    currentQuestionIndex++;
-}
-
-void MainWindow::onTimeOut() {
-    // 停止計時器
-    questionTimer->stop();
-
-    // 自動保存並跳轉到下一題
-    saveCanvas();
-    QMessageBox::information(this, "時間到", "已超過時間！");
-}
-
-void MainWindow::updateTimer() {
-    remainingTime--;
-    timeLabel->setText(QString("倒數時間：%1").arg(remainingTime));
-
-    if (remainingTime <= 0) {
-        // 停止計時器
-        questionTimer->stop();
-
-        // 自動保存並跳轉到下一題
-        QMessageBox::information(this, "時間到", "已超過時間！");
-        saveCanvas();
-    }
-}
-
-
-void MainWindow::chooseColor() {
-    QColor color = QColorDialog::getColor(Qt::black, this, "選擇顏色");
-    if (color.isValid()) {
-        canvas->setBrushColor(color);
-    }
-}
-
-// 保存圖片並啟動監視
-void MainWindow::saveCanvas() {
-    qDebug() << "saveCanvas called";
-    QString directory = "C:/Users/jason/Desktop/py_quickDraw_ndjson2img/py_quickDraw_ndjson2img/images";
-
-    // 確保目錄存在
-    QDir dir(directory);
-    if (!dir.exists()) {
-        dir.mkpath(directory);
-    }
-
-    // 使用當前題目作為檔名
-    QString fileName = currentQuestion + ".png";
-    QString filePath = directory + "/" + fileName;
-
-    // 保存圖片
-    if (canvas->getPixmap().save(filePath)) {
-        //QMessageBox::information(this, "保存成功", "圖片已保存到:\n" + filePath);
-        // 停止計時器並隱藏倒計時
-        questionTimer->stop();
-        timeLabel->hide();
-
-        // 創建進度條窗口
-        QDialog *progressDialog = new QDialog(this);
-        progressDialog->setWindowTitle("辨識中...");
-        progressDialog->resize(300, 100);
-
-        QVBoxLayout *layout = new QVBoxLayout(progressDialog);
-        QLabel *label = new QLabel("正在辨識圖片，請稍候...", progressDialog);
-        label->setAlignment(Qt::AlignCenter);
-        QProgressBar *progressBar = new QProgressBar(progressDialog);
-        progressBar->setRange(0, 0); // 無限進度模式
-        layout->addWidget(label);
-        layout->addWidget(progressBar);
-
-        progressDialog->setLayout(layout);
-        progressDialog->setModal(true);
-        progressDialog->show();
-
-        // 延遲5秒後開始監視
-        QTimer::singleShot(10000, this, [this, progressDialog]() {
-            progressDialog->accept();  // 關閉進度條窗口
-            fileCheckTimer->start(1000);  // 每秒檢查一次
-            qDebug() << "開始監視 result.txt";
-        });
-    } else {
-        QMessageBox::warning(this, "保存失敗", "無法保存圖片到指定路徑:\n" + filePath);
-    }
-}
-
-
-void MainWindow::monitorResultFile() {
-    QFile resultFile(resultFilePath);
-
-    // 確保文件存在
-    if (!resultFile.exists()) {
-        return;  // 文件尚未生成，繼續監視
-    }
-
-    // 打開文件
-    if (!resultFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "無法打開 result.txt";
-        return;
-    }
-
-    QTextStream in(&resultFile);
-    QString lastLine;
-
-    // 讀取最後一行
-    while (!in.atEnd()) {
-        lastLine = in.readLine();
-    }
-    resultFile.close();
-    // 調試輸出
-    qDebug() << "讀取到的最後一行：" << lastLine;
-
-    // 檢查內容並顯示結果
-    if (lastLine.contains("Result: yes")) {
-        QMessageBox::information(this, "辨識結果", "正確！");
-    } else if (lastLine.contains("Result: no")) {
-        QMessageBox::critical(this, "辨識結果", "錯誤！");
-    } else {
-        qDebug() << "文件格式不正確，繼續監視...";
-        return;  // 尚未生成完整結果，繼續監視
-    }
-
-    // 停止監視
-    fileCheckTimer->stop();
-    qDebug() << "監視已停止";
-
-    // 顯示下一題
-    showNextQuestion();
-}
-
-
-// 顯示總結
-void MainWindow::showSummary() {
-    // 創建新窗口顯示總結
-    QDialog *summaryDialog = new QDialog(this);
-    summaryDialog->setWindowTitle("答題總結");
-    summaryDialog->resize(800, 600);
-
-    QVBoxLayout *mainLayout = new QVBoxLayout(summaryDialog);
-    QGridLayout *gridLayout = new QGridLayout();
-
-    // 打開 result.txt 文件
-    QFile resultFile(resultFilePath);
-    if (!resultFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "錯誤", "無法打開結果文件！");
-        return;
-    }
-
-    QTextStream in(&resultFile);
-    QStringList lines;
-    while (!in.atEnd()) {
-        lines.append(in.readLine());
-    }
-    resultFile.close();
-
-    // 確保只有 6 題結果
-    int numQuestions = qMin(lines.size(), 6);
-
-    for (int i = 0; i < numQuestions; ++i) {
-        QString line = lines[i];
-        QStringList parts = line.split("|");
-        if (parts.size() < 4) continue;
-
-        QString imageFile = parts[0].split(":").last().trimmed();
-        QString predictedClass = parts[0].split(":").last().trimmed();  // 獲取 Predicted Class
-        predictedClass.remove(".png");
-        QString result = parts[3].split(":").last().trimmed();
-
-        QString questionNumber = QString("第 %1 題").arg(i + 1);
-
-        // 加載圖片
-        QString imagePath = QString("C:/Users/jason/Desktop/py_quickDraw_ndjson2img/py_quickDraw_ndjson2img/resultfile/%1").arg(imageFile);
-        QLabel *imageLabel = new QLabel();
-        QPixmap pixmap(imagePath);
-        if (!pixmap.isNull()) {
-            imageLabel->setPixmap(pixmap.scaled(200, 150, Qt::KeepAspectRatio));
-        } else {
-            imageLabel->setText("無法加載圖片");
-        }
-        imageLabel->setAlignment(Qt::AlignCenter);  // 圖片居中顯示
-
-        // 顯示題號標籤
-        QLabel *questionLabel = new QLabel(questionNumber, summaryDialog);
-        questionLabel->setAlignment(Qt::AlignCenter);
-        questionLabel->setStyleSheet(
-            "font-size: 16px; "
-            "font-weight: bold; "
-            "color: #4CAF50; "  // 顯示綠色
-            "padding: 8px; "
-            "border: 2px solid #4CAF50; "
-            "border-radius: 5px; "
-            "background-color: #e8f5e9;"  // 淺綠色背景
-            );
-
-        // 顯示題目名稱
-        QLabel *titleLabel = new QLabel(QString("題目：%1").arg(predictedClass), summaryDialog);
-        titleLabel->setAlignment(Qt::AlignCenter);
-        titleLabel->setStyleSheet(
-            "font-size: 14px; "
-            "font-weight: bold; "
-            "color: White; "  // 顯示深灰色字體
-            "padding: 5px;"
-            );
-
-        // 顯示答案標籤
-        QString resultText = result == "yes" ? "正確" : "錯誤";
-        QLabel *resultLabel = new QLabel(resultText, summaryDialog);
-        resultLabel->setAlignment(Qt::AlignCenter);
-        resultLabel->setStyleSheet(
-            result == "yes" ?
-                "font-size: 14px; "
-                "color: white; "
-                "background-color: green; "  // 正確顯示綠色背景
-                "border-radius: 5px; "
-                "padding: 8px;" :
-                "font-size: 14px; "
-                "color: white; "
-                "background-color: red; "  // 錯誤顯示紅色背景
-                "border-radius: 5px; "
-                "padding: 8px;"
-            );
-
-
-        // 外圍布局調整
-        QVBoxLayout *vLayout = new QVBoxLayout();
-        vLayout->addWidget(questionLabel);
-        vLayout->addWidget(titleLabel);
-        vLayout->addWidget(imageLabel);
-        vLayout->addWidget(resultLabel);
-        vLayout->setSpacing(10);  // 控制元素之間的間距
-        vLayout->setAlignment(Qt::AlignCenter);  // 垂直布局居中
-
-        // 外圍容器
-        QWidget *questionWidget = new QWidget();
-        questionWidget->setLayout(vLayout);
-
-        // 添加到 Grid Layout 中
-        int row = i / 3;  // 行數
-        int col = i % 3;  // 列數
-        gridLayout->addWidget(questionWidget, row, col);
-    }
-
-
-    mainLayout->addLayout(gridLayout);
-
-    // 添加按鈕
-    QHBoxLayout *buttonLayout = new QHBoxLayout();
-    QPushButton *playAgainButton = new QPushButton("再玩一局", summaryDialog);
-    playAgainButton->setStyleSheet("QPushButton {"
-                                   "border: 2px solid white;"   // 白色邊框
-                                   "background-color: yellow;"  // 黃色背景
-                                   "color: black;"              // 黑色文字
-                                   "font-size: 20px;"           // 文字大小
-                                   "padding: 5px 10px;"         // 按鈕內邊距
-                                   "border-radius: 5px;"        // 圓角邊框
-                                   "}");
-    QPushButton *exitButton = new QPushButton("結束遊戲", summaryDialog);
-    exitButton->setStyleSheet("QPushButton {"
-                              "border: 2px solid white;"   // 白色邊框
-                              "background-color: yellow;"  // 黃色背景
-                              "color: black;"              // 黑色文字
-                              "font-size: 20px;"           // 文字大小
-                              "padding: 5px 10px;"         // 按鈕內邊距
-                              "border-radius: 5px;"        // 圓角邊框
-                              "}");
-
-    connect(playAgainButton, &QPushButton::clicked, this, [this, summaryDialog]() {
-        clearResults();  // 清空結果文件與資料夾
-        summaryDialog->accept();  // 關閉總結窗口
-        startGame();  // 開始新遊戲
-    });
-
-    // 結束遊戲
-    connect(exitButton, &QPushButton::clicked, this, [this]() {
-        clearResults();  // 清空結果文件與資料夾
-        QApplication::quit();  // 結束程式
-    });
-
-    buttonLayout->addWidget(playAgainButton);
-    buttonLayout->addWidget(exitButton);
-
-    mainLayout->addLayout(buttonLayout);
-
-    summaryDialog->exec();
-}
-
-
-void MainWindow::clearResults() {
-    // 清空 result.txt 文件
-    QFile resultFile(resultFilePath);
-    if (resultFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        resultFile.resize(0);  // 清空文件內容
-        resultFile.close();
-    }
-
-    // 刪除 resultfile 資料夾中的所有文件
-    QDir resultDir("C:/Users/jason/Desktop/py_quickDraw_ndjson2img/py_quickDraw_ndjson2img/resultfile");
-    if (resultDir.exists()) {
-        for (const QFileInfo &fileInfo : resultDir.entryInfoList(QDir::Files)) {
-            QFile::remove(fileInfo.absoluteFilePath());
-        }
-    }
-}
-
-
+﻿#include "mainwindow.h"
+#include "drawinghistory.h"
+#include "historywindow.h"
+#include <QBuffer>
+#include <QShortcut>
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+// 刪除檔案或資料夾；cutoff 有效時只刪除該時間點之前修改的檔案
+void purgePath(const QString &path, const QDateTime &cutoff) {
+    QFileInfo info(path);
+    if (!info.isDir()) {
+        QFile::remove(path);
+        return;
+    }
+    if (!cutoff.isValid()) {
+        QDir(path).removeRecursively();
+        return;
+    }
+    QDir dir(path);
+    for (const QFileInfo &fileInfo : dir.entryInfoList(QDir::Files)) {
+        if (fileInfo.lastModified() < cutoff) {
+            QFile::remove(fileInfo.absoluteFilePath());
+        }
+    }
+}
+}
+
+MainWindow::MainWindow(const AppConfig &config, QWidget *parent)
+    : QMainWindow(parent), config(config), resultFilePath(config.resultFilePath()),
+      resultFolderPath(config.resultFolderPath()) {
+
+    // 清掉上次異常結束時留下的暫存垃圾
+    sweepStaleTrash();
+
+    // Ctrl+Shift+L 輸出各階段延遲統計
+    auto *latencyShortcut = new QShortcut(QKeySequence("Ctrl+Shift+L"), this);
+    connect(latencyShortcut, &QShortcut::activated, this, [this]() {
+        qInfo().noquote() << latency.report();
+        qInfo().noquote() << inference->cacheSummary();
+        qInfo().noquote() << inference->schedulerSummary();
+    });
+
+    // Ctrl+H 瀏覽歷史作品
+    auto *historyShortcut = new QShortcut(QKeySequence("Ctrl+H"), this);
+    connect(historyShortcut, &QShortcut::activated, this, &MainWindow::showHistory);
+
+    // Ctrl+Shift+R 輸出目前持有的物件與點陣圖
+    auto *resourceShortcut = new QShortcut(QKeySequence("Ctrl+Shift+R"), this);
+    connect(resourceShortcut, &QShortcut::activated, this, [this]() {
+        qInfo().noquote() << resourceStats().toString();
+    });
+
+    // 背景載入並暖機模型，完成前不能開始遊戲
+    inference = new InferenceService(this);
+    connect(inference, &InferenceService::modelReady, this, &MainWindow::onModelReady);
+    connect(inference, &InferenceService::modelReloaded, this, [](bool ok, const QString &message) {
+        if (ok) {
+            qInfo().noquote() << message;   // 新題目池從下一局開始使用
+        } else {
+            qWarning().noquote() << message;
+        }
+    });
+
+    // Ctrl+Shift+M 立即重新載入模型與標籤
+    auto *reloadShortcut = new QShortcut(QKeySequence("Ctrl+Shift+M"), this);
+    connect(reloadShortcut, &QShortcut::activated, this, [this]() { inference->reload(); });
+
+    connect(inference, &InferenceService::classified, this,
+            [this](const Prediction &prediction, int, InferenceScheduler::Priority priority) {
+        if (priority == InferenceScheduler::Preview) {
+            onPreviewClassified(prediction);
+        } else if (priority == InferenceScheduler::Background) {
+            onRescored(prediction);
+        } else {
+            onClassified(prediction);
+        }
+    });
+
+    // 提前結束：作畫時定期背景辨識，需要回傳各類別機率的後端（程序內模型、辨識伺服器或 mock）
+    previewTimer = new QTimer(this);
+    connect(previewTimer, &QTimer::timeout, this, &MainWindow::requestPreview);
+
+    // 初始化計時器
+    questionTimer = new QTimer(this);
+    connect(questionTimer, &QTimer::timeout, this, &MainWindow::updateTimer);
+    // 顯示對錯後停留 resultDisplayMs 再進入下一題，期間事件迴圈照常運作
+    delayTimer = new QTimer(this);
+    delayTimer->setSingleShot(true);
+    connect(delayTimer, &QTimer::timeout, this, &MainWindow::showNextQuestion);
+    // 初始化倒計時顯示
+    timeLabel = new QLabel("倒數時間：30", this);
+    timeLabel->setAlignment(Qt::AlignCenter);
+    timeLabel->setStyleSheet("font-size: 30px; color: white;");
+    timeLabel->hide(); // 開始遊戲前隱藏
+
+    // 題目池在每局開始時由標籤檔產生（見 updateQuestionPool）
+    currentQuestionIndex = 0;
+
+    // 初始化畫布
+    canvas = new Canvas(this);
+    canvas->setObjectName("canvas");
+    canvas->setGrayscale(config.grayscaleCanvas);
+    canvas->setModelInputSize(InferenceEngine::InputSize);   // 背景辨識與提交直接取用模型解析度的緩衝
+    canvas->hide(); // 一開始隱藏畫布
+
+    // F3 切換畫布效能抬頭顯示
+    auto *hudShortcut = new QShortcut(QKeySequence(Qt::Key_F3), this);
+    connect(hudShortcut, &QShortcut::activated, canvas, [this]() {
+        canvas->setHudEnabled(!canvas->isHudEnabled());
+    });
+
+    // 初始化主要佈局
+    mainLayout = new QVBoxLayout();
+    controls = new QHBoxLayout();
+
+    // 顯示題目的標籤
+    questionLabel = new QLabel("題目：", this);
+    questionLabel->setObjectName("questionLabel");
+    questionLabel->setAlignment(Qt::AlignCenter);
+
+    // 設置字體大小並加粗
+    QFont font = questionLabel->font();
+    font.setPointSize(30);  // 設置字體大小為 20
+    font.setBold(true);     // 設置字體加粗
+    questionLabel->setFont(font);
+
+    questionLabel->hide(); // 開始遊戲前隱藏
+
+
+    // 調色盤按鈕
+    auto *colorButton = new QPushButton("調色盤");
+    colorButton->setStyleSheet("QPushButton {"
+                              "border: 2px solid white;"   // 白色邊框
+                              "background-color: yellow;"  // 黃色背景
+                              "color: black;"              // 黑色文字
+                              "font-size: 20px;"           // 文字大小
+                              "padding: 5px 10px;"         // 按鈕內邊距
+                              "border-radius: 5px;"        // 圓角邊框
+                              "}");
+    connect(colorButton, &QPushButton::clicked, this, &MainWindow::chooseColor);
+    controls->addWidget(colorButton);
+    colorButton->hide(); // 開始遊戲前隱藏
+
+    // 粗細調節滑塊
+    auto *sizeLabel = new QLabel("粗細: 5");
+    auto *sizeSlider = new QSlider(Qt::Horizontal);
+    sizeSlider->setRange(1, 30);
+    sizeSlider->setValue(5);
+
+    // 設置字體大小並加粗
+    QFont fontsize = sizeLabel->font();
+    fontsize.setPointSize(18);  // 設置字體大小為 18
+    sizeLabel->setFont(fontsize);
+
+    connect(sizeSlider, &QSlider::valueChanged, [this, sizeLabel](int value) {
+        sizeLabel->setText("粗細: " + QString::number(value));
+        canvas->setBrushSize(value);
+    });
+
+    controls->addWidget(sizeLabel);
+    controls->addWidget(sizeSlider);
+
+    // 開始遊戲前隱藏滑塊和顯示的標籤
+    sizeLabel->hide();
+    sizeSlider->hide();
+
+
+    // 保存按鈕
+    auto *saveButton = new QPushButton("保存");
+    saveButton->setObjectName("saveButton");
+    saveButton->setStyleSheet("QPushButton {"
+                              "border: 2px solid white;"   // 白色邊框
+                              "background-color: yellow;"  // 黃色背景
+                              "color: black;"              // 黑色文字
+                              "font-size: 20px;"           // 文字大小
+                              "padding: 5px 10px;"         // 按鈕內邊距
+                              "border-radius: 5px;"        // 圓角邊框
+                              "}");
+    connect(saveButton, &QPushButton::clicked, this, &MainWindow::saveCanvas);
+    controls->addWidget(saveButton);
+    saveButton->hide();
+
+    // 清除畫布按鈕
+    auto *clearButton = new QPushButton("清除畫布");
+    clearButton->setStyleSheet("QPushButton {"
+                               "border: 2px solid white;"   // 白色邊框
+                               "background-color: yellow;"  // 黃色背景
+                               "color: black;"              // 黑色文字
+                               "font-size: 20px;"           // 文字大小
+                               "padding: 5px 10px;"         // 按鈕內邊距
+                               "border-radius: 5px;"        // 圓角邊框
+                               "}");
+    connect(clearButton, &QPushButton::clicked, canvas, &Canvas::clearCanvas);
+    controls->addWidget(clearButton);
+    clearButton->hide();
+
+    // 開始遊戲按鈕
+    startButton = new QPushButton("開始遊戲", this);
+    startButton->setObjectName("startButton");
+    startButton->setStyleSheet("QPushButton {"
+                               "border: 2px solid white;"   // 白色邊框
+                               "background-color: yellow;"  // 黃色背景
+                               "color: black;"              // 黑色文字
+                               "font-size: 80px;"           // 文字大小
+                               "padding: 5px 10px;"         // 按鈕內邊距
+                               "border-radius: 5px;"        // 圓角邊框
+                               "}");
+    connect(startButton, &QPushButton::clicked, this, &MainWindow::startGame);
+    startButton->setEnabled(false);
+    startButton->setText("模型載入中...");
+
+
+    // 佈局
+    auto *centralWidget = new QWidget();
+    auto *layout = new QVBoxLayout();
+     layout->addWidget(timeLabel); // 添加倒計時顯示
+    layout->addWidget(questionLabel);
+    layout->addWidget(canvas, 0, Qt::AlignCenter);
+    layout->addLayout(controls);
+    layout->addWidget(startButton, 0, Qt::AlignCenter);
+    centralWidget->setLayout(layout);
+    setCentralWidget(centralWidget);
+
+    setWindowTitle("小畫家");
+    resize(800, 600);
+
+    // 提示訊息疊在視窗上方，整個程式只用這一個
+    toast = new Toast(this);
+
+    // 進度與總結視窗只建立一次，之後重複使用
+    buildProgressDialog();
+    buildSummaryDialog();
+
+    inference->start(config);
+}
+
+
+MainWindow::~MainWindow() {
+    Tracer::instance().flush();
+    // 等待背景清理完成，避免程式結束時刪到一半
+    for (QFuture<void> &task : cleanupTasks) {
+        task.waitForFinished();
+    }
+}
+
+
+void MainWindow::startGame() {
+    qDebug() << "startGame called";
+    updateQuestionPool();
+    if (questionPool.isEmpty()) {
+        toast->showMessage("無法開始：找不到標籤檔\n" + config.labelsPath, Toast::Error, 4000);
+        startButton->show();
+        return;
+    }
+
+    // 隱藏開始遊戲按鈕
+    startButton->hide();
+
+    // 隨機排列6個題目
+    std::random_device rd; // 用於生成隨機種子
+    std::mt19937 g(rd()); // Mersenne Twister 隨機數生成器
+    std::shuffle(questionPool.begin(), questionPool.end(), g);
+    questionQueue = questionPool.mid(0, questionsPerGame); // 取前6個題目
+
+    // 顯示畫布
+    canvas->show();
+
+    // 顯式顯示每個控件
+    for (int i = 0; i < controls->count(); ++i) {
+        QWidget *widget = controls->itemAt(i)->widget();
+        if (widget) {
+            widget->show();
+        }
+    }
+
+    // 更新佈局
+    update();
+
+    // 初始化索引並顯示第一題
+    currentQuestionIndex = 0;
+    heldResults.clear();
+    canvas->clearCanvas();
+    showNextQuestion();
+}
+
+
+
+void MainWindow::showNextQuestion() {
+    // 如果所有題目完成，顯示總結
+    if (currentQuestionIndex >= questionQueue.size()) {
+        if (!pendingSubmissions.isEmpty()) {
+            // 還有題目在辨識，最後一個結果由 showResult 接回這裡
+            setState(GameState::Submitting);
+            progressDialog->show();
+        } else if (state != GameState::Result) {
+            // 最後一題的對錯停留 resultDisplayMs，再由 delayTimer 回到這裡
+            setState(GameState::Result);
+            delayTimer->start(config.resultDisplayMs);
+        } else {
+            toast->showMessage("所有題目完成！", Toast::Info);
+            showSummary(); // 顯示總結視窗
+        }
+        return;
+    }
+
+
+    // 更新當前題目（上一題交出畫布時已換上空白的緩衝，不必再清除）
+    currentQuestion = questionQueue[currentQuestionIndex];
+    questionLabel->setText("題目：" + currentQuestion);
+    questionLabel->show();
+    canvas->show();
+
+    // 重置倒計時
+    remainingTime = questionTimeLimit;
+    timeLabel->setText(QString("倒數時間：%1").arg(remainingTime));
+    timeLabel->show();
+
+    // 啟動計時器
+    questionTimer->start(1000); // 每秒觸發一次
+    setState(GameState::Drawing);
+
+    // 背景辨識：重設連續達標次數並找出題目在模型輸出中的位置
+    confidentStreak = 0;
+    revisionAtQuestionStart = canvas->revision();
+    lastPreviewRevision = revisionAtQuestionStart;
+    ++questionSequence;
+    previewQuestions.clear();   // 上一題還沒回來的預覽查不到題號，回來時直接丟棄
+    targetClassIndex = inference->labels().indexOf(currentQuestion.toLower());
+    if (config.earlyFinishConfidence > 0 && inference->isReady() && inference->modelInfo().hasScores
+        && targetClassIndex >= 0) {
+        previewTimer->start(config.previewIntervalMs);
+    }
+
+    if (!config.recordingsDir.isEmpty()) {
+        canvas->startRecording(currentQuestion);
+    }
+
+    // 增加索引
+    currentQuestionIndex++;
+}
+
+void MainWindow::updateTimer() {
+    remainingTime--;
+    timeLabel->setText(QString("倒數時間：%1").arg(remainingTime));
+
+    if (remainingTime <= 0) {
+        // 停止計時器；背景辨識也先停下，時間到之後的預覽結果不能再提前結束這一題
+        questionTimer->stop();
+        previewTimer->stop();
+
+        // 立即提交，提示與辨識同時進行，不等玩家關閉訊息
+        toast->showMessage("時間到！", Toast::Warning);
+        saveCanvas();
+    }
+}
+
+
+void MainWindow::chooseColor() {
+    QColor color = QColorDialog::getColor(Qt::black, this, "選擇顏色");
+    if (color.isValid()) {
+        canvas->setBrushColor(color);
+    }
+}
+
+// 保存圖片並送出辨識
+void MainWindow::saveCanvas() {
+    qDebug() << "saveCanvas called";
+    // 只在作畫中接受提交：時間到與按下保存可能落在同一輪事件，第二次直接略過
+    if (state != GameState::Drawing) {
+        return;
+    }
+    previewTimer->stop();
+    inference->cancelPreviews();
+    saveRecording();
+
+    // 停止計時器並隱藏倒計時
+    questionTimer->stop();
+    timeLabel->hide();
+
+    // 每次提交的編號寫進 PNG 的文字欄位，Python 端的追蹤紀錄以此對應
+    PendingSubmission pending;
+    pending.id = Tracer::newSubmissionId();
+    pending.questionIndex = currentQuestionIndex - 1;   // 出題時已指向下一題
+    pending.question = currentQuestion;
+    pending.saveStartMicros = SubmissionLatency::nowMicros();
+    const quint64 submissionId = pending.id;
+    TraceSpan saveSpan("saveCanvas", submissionId);
+
+    // 交出畫布緩衝（不複製），畫布立刻換上空白的備用緩衝給下一題
+    pending.frame = canvas->takeFrame();
+    QImage &drawing = pending.frame.image;   // 單色畫布為 8 位元灰階，PNG 與模型輸入都維持單通道
+    drawing.setText("SubmissionId", QString::number(submissionId));
+    drawing.setText("Question", currentQuestion);   // Python 流程以題目命名檔案，lite.py 以檔名判斷對錯
+
+    // Python 流程由辨識後端把圖片存進 images，辨識完再移到結果資料夾；
+    // 其他後端由這裡直接存到結果資料夾供總結頁顯示：分開記錄編碼與寫檔的時間
+    if (!inference->modelInfo().writesResultFile) {
+        QDir().mkpath(resultFolderPath);
+        const QString filePath = resultFolderPath + "/" + currentQuestion + ".png";
+        QByteArray png;
+        bool saved;
+        {
+            TraceSpan span("encode", submissionId);
+            QBuffer buffer(&png);
+            saved = buffer.open(QIODevice::WriteOnly) && drawing.save(&buffer, "PNG");
+        }
+        pending.encodeDoneMicros = SubmissionLatency::nowMicros();
+        {
+            TraceSpan span("write", submissionId);
+            QFile imageFile(filePath);
+            saved = saved && imageFile.open(QIODevice::WriteOnly) && imageFile.write(png) == png.size();
+        }
+        pending.fileWrittenMicros = SubmissionLatency::nowMicros();
+        if (!saved) {
+            // 辨識不需要這個檔案，照樣提交；只有總結頁會少這張圖
+            qWarning().noquote() << "無法保存圖片到指定路徑：" + filePath;
+            toast->showMessage("保存失敗，總結頁將不會顯示這張圖", Toast::Error, 3000);
+        }
+    }
+    Tracer::instance().flowStart(submissionId, SubmissionLatency::nowMicros());
+
+    // 需要固定輸入大小的後端直接使用畫布逐筆同步的模型緩衝，提交時不必再縮放整張畫布
+    QImage modelInput = drawing;
+    QImage &buffered = pending.frame.modelImage;
+    if (!buffered.isNull() && buffered.width() == inference->modelInfo().inputSize) {
+        buffered.setText("SubmissionId", QString::number(submissionId));
+        buffered.setText("Question", currentQuestion);
+        modelInput = buffered;
+    }
+    inference->classify(modelInput, submissionId);
+    pendingSubmissions.enqueue(pending);
+
+    // 不等辨識結果，直接出下一題；結果由 onClassified 以提示顯示
+    showNextQuestion();
+}
+
+
+// 題目池取自目前模型的標籤；沒有程序內模型時讀取設定中的標籤檔（與 Python 端相同的格式）
+// 每局開始時重新取得，換了模型或標籤檔後下一局就會使用新的類別
+void MainWindow::updateQuestionPool() {
+    QStringList labels = inference->labels();
+    if (labels.isEmpty()) {
+        QString error;
+        labels = InferenceEngine::loadLabels(config.labelsPath, &error);
+        if (labels.isEmpty()) {
+            qWarning().noquote() << error;
+        }
+    }
+    questionPool = labels;
+}
+
+
+void MainWindow::onModelReady(bool ok, const QString &message) {
+    // 後端無法使用時 InferenceService 已自動改走 Python 流程；仍失敗表示設定指定的後端無法啟動
+    if (!ok) {
+        qWarning().noquote() << "辨識後端無法使用：" + message;
+        startButton->setText("辨識後端無法使用");
+        startButton->setEnabled(false);
+        return;
+    }
+    qDebug() << message;
+    startButton->setText("開始遊戲");
+    startButton->setEnabled(true);
+}
+
+
+void MainWindow::onClassified(const Prediction &prediction) {
+    // 不在等待中的編號（例如上一局遲到的結果）不會推進遊戲
+    auto it = std::find_if(pendingSubmissions.begin(), pendingSubmissions.end(),
+                           [&prediction](const PendingSubmission &pending) { return pending.id == prediction.submissionId; });
+    if (it == pendingSubmissions.end()) {
+        return;
+    }
+    PendingSubmission pending = std::move(*it);
+    pendingSubmissions.erase(it);
+    TraceSpan span("result_parse", pending.id);
+
+    // 保存階段的時間戳在提交時記下，之後才開始本次的延遲統計（前一題的結果可能晚於這題提交）
+    latency.begin(pending.saveStartMicros);
+    if (pending.encodeDoneMicros) {
+        latency.stamp(SubmissionLatency::EncodeDone, pending.encodeDoneMicros);
+    }
+    if (pending.fileWrittenMicros) {
+        latency.stamp(SubmissionLatency::FileWritten, pending.fileWrittenMicros);
+    }
+    // Python 流程另有監看程式與 lite.py 啟動的時間戳
+    if (prediction.fileVisibleMicros) {
+        latency.stamp(SubmissionLatency::FileVisible, prediction.fileVisibleMicros);
+    }
+    if (prediction.scriptStartMicros) {
+        latency.stamp(SubmissionLatency::ScriptStart, prediction.scriptStartMicros);
+    }
+    if (prediction.startedMicros) {
+        latency.stamp(SubmissionLatency::InferenceStart, prediction.startedMicros);
+    }
+    if (prediction.finishedMicros) {
+        latency.stamp(SubmissionLatency::InferenceEnd, prediction.finishedMicros);
+    }
+    latency.stamp(SubmissionLatency::ResultParsed);
+
+    // 與 lite.py 相同：比較題目與預測類別；Python 流程已自行寫入 result.txt
+    const bool correct = prediction.isValid() && prediction.label == pending.question.toLower();
+    if (!inference->modelInfo().writesResultFile) {
+        appendResultLine(pending.question + ".png", prediction, correct);
+    }
+    flushHeldResults();
+    canvas->recycleFrame(std::move(pending.frame));   // 趁玩家作畫時清空，下次換題直接使用
+    showResult(pending.question, correct, pending.saveStartMicros);
+}
+
+
+// 送出目前畫布做背景辨識；還沒開始畫就略過
+// 排程器只保留最新一筆預覽，推理跟不上時舊的會被取代，不會越積越多
+// 沒有新筆畫時不送出：同一張畫布重複評估（多半由結果快取直接回傳）不能算作連續達標
+void MainWindow::requestPreview() {
+    const quint64 revision = canvas->revision();
+    if (revision == revisionAtQuestionStart || revision == lastPreviewRevision) {
+        return;
+    }
+    lastPreviewRevision = revision;
+    const quint64 id = Tracer::newSubmissionId();
+    previewQuestions.insert(id, questionSequence);
+    inference->classify(canvas->modelImage(), id, 0, InferenceScheduler::Preview);
+}
+
+
+void MainWindow::onPreviewClassified(const Prediction &prediction) {
+    // 編號由牆上時鐘產生，時鐘回撥時不能以大小判斷新舊；改以送出時記下的題號辨識上一題的遲到結果
+    const quint64 sequence = previewQuestions.take(prediction.submissionId);
+    if (!previewTimer->isActive() || sequence != questionSequence) {
+        return;   // 已經提交、時間到或換題
+    }
+    // 只多一小筆的畫布 dHash 仍在快取距離內，回傳的是上一次的結果；模型沒有重新評估，不算一次
+    if (prediction.cached) {
+        return;
+    }
+    if (prediction.scores.value(targetClassIndex) >= config.earlyFinishConfidence) {
+        ++confidentStreak;
+    } else {
+        confidentStreak = 0;
+    }
+    if (confidentStreak >= config.earlyFinishStreak) {
+        finishEarly(prediction);
+    }
+}
+
+
+// 總結頁的重新評分：列出模型機率最高的三個類別
+void MainWindow::onRescored(const Prediction &prediction) {
+    const int cellIndex = rescoringCells.value(prediction.submissionId, -1);
+    rescoringCells.remove(prediction.submissionId);
+    if (cellIndex < 0 || !prediction.isValid()) {
+        return;
+    }
+    const QStringList labels = inference->labels();
+    QStringList guesses;
+    for (int index : Classifier::topK(prediction, 3)) {
+        guesses << QString("%1 %2%").arg(labels.value(index)).arg(qRound(prediction.scores.value(index) * 100));
+    }
+    summaryCells[cellIndex].guessLabel->setText("模型猜測：" + guesses.join("、"));
+}
+
+
+// 背景辨識已確認答對：不必等玩家按保存或倒數結束
+void MainWindow::finishEarly(const Prediction &prediction) {
+    previewTimer->stop();
+    questionTimer->stop();
+    timeLabel->hide();
+    saveRecording();
+
+    // 與正式提交相同，圖片存到結果資料夾供總結頁顯示；畫布同樣換上備用緩衝
+    Canvas::Frame frame = canvas->takeFrame();
+    QDir().mkpath(resultFolderPath);
+    frame.image.save(resultFolderPath + "/" + currentQuestion + ".png");
+    canvas->recycleFrame(std::move(frame));
+    // 達標的是題目類別的機率，不一定是第一名；result.txt 記錄題目類別與它的機率，才不會出現「預測 X、正確」
+    Prediction answered = prediction;
+    answered.classIndex = targetClassIndex;
+    answered.label = currentQuestion.toLower();
+    answered.confidence = prediction.scores.value(targetClassIndex);
+    heldResults.append({currentQuestionIndex - 1, currentQuestion + ".png", answered});
+    flushHeldResults();
+    showResult(currentQuestion, true);
+    showNextQuestion();
+}
+
+
+// 這一題的筆畫追加到當天的錄製檔，之後可用 --replay 重播（待機畫面、重現玩家回報的問題）
+void MainWindow::saveRecording() {
+    const StrokeRecording recording = canvas->takeRecording();
+    if (config.recordingsDir.isEmpty() || recording.isEmpty()) {
+        return;
+    }
+    const QString path = QString("%1/%2.qdsr").arg(config.recordingsDir, QDate::currentDate().toString("yyyy-MM-dd"));
+    if (!recording.appendTo(path)) {
+        qDebug() << "無法寫入筆畫錄製檔" << path;
+    }
+}
+
+
+// 以與 lite.py 相同的格式追加結果，讓總結頁面沿用同一份 result.txt
+void MainWindow::appendResultLine(const QString &imageFile, const Prediction &prediction, bool correct) {
+    QFile resultFile(resultFilePath);
+    if (!resultFile.open(QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "無法寫入 result.txt";
+        return;
+    }
+    QTextStream out(&resultFile);
+    out << "Image: " << imageFile
+        << " | Predicted Class: " << prediction.label
+        << " | Confidence: " << QString::number(prediction.confidence, 'f', 2)
+        << " | Result: " << (correct ? "yes" : "no") << "\n";
+}
+
+
+// 總結頁與歸檔依 result.txt 的行序對應題號，提前答對的結果不能排在還在辨識的前一題之前
+// 辨識結果依提交順序回來（Python 流程由辨識端寫入），前面的題目都有結果了才追加
+void MainWindow::flushHeldResults() {
+    int firstPending = std::numeric_limits<int>::max();
+    for (const PendingSubmission &pending : pendingSubmissions) {
+        firstPending = qMin(firstPending, pending.questionIndex);
+    }
+    while (!heldResults.isEmpty() && heldResults.first().questionIndex < firstPending) {
+        const HeldResult held = heldResults.takeFirst();
+        appendResultLine(held.imageFile, held.prediction, true);
+    }
+}
+
+
+// 以提示顯示辨識結果，不打斷正在畫的下一題；最後一題的結果回來後才結束這一局
+void MainWindow::showResult(const QString &question, bool correct, qint64 submittedMicros) {
+    // 提前結束的題目沒有經過 begin()，finish() 不會增加 rounds()，只在次數剛增加時輸出
+    const int roundsBefore = latency.rounds();
+    latency.stamp(SubmissionLatency::UiShown);
+    latency.finish();
+    Tracer::instance().flush();
+    if (config.latencyLogEvery > 0 && latency.rounds() > roundsBefore
+        && latency.rounds() % config.latencyLogEvery == 0) {
+        qInfo().noquote() << latency.summaryLine();
+        if (inference->isReady()) {
+            qInfo().noquote() << inference->cacheSummary();
+            qInfo().noquote() << inference->schedulerSummary();
+        }
+    }
+
+    if (correct) {
+        toast->showMessage(question + "：正確！", Toast::Success, config.resultDisplayMs);
+    } else {
+        toast->showMessage(question + "：錯誤！", Toast::Warning, config.resultDisplayMs);
+    }
+    emit answerShown(correct, submittedMicros);
+
+    if (state == GameState::Submitting && pendingSubmissions.isEmpty()) {
+        progressDialog->accept();  // 關閉進度條窗口
+        showNextQuestion();        // 停留後顯示總結
+    }
+}
+
+
+// 顯示總結
+void MainWindow::showSummary() {
+    std::optional<TraceSpan> span(std::in_place, "summary_build");
+
+    // 打開 result.txt 文件
+    QFile resultFile(resultFilePath);
+    if (!resultFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        toast->showMessage("無法打開結果文件！", Toast::Error, 4000);
+        setState(GameState::Idle);
+        startButton->show();
+        return;
+    }
+
+    QTextStream in(&resultFile);
+    QStringList lines;
+    while (!in.atEnd() && lines.size() < questionsPerGame) {
+        lines.append(in.readLine());
+    }
+    resultFile.close();
+
+    // 後端有各類別機率時，在閒置時以背景工作重新評分，格子下方補上模型的前三名猜測
+    rescoringCells.clear();
+    const bool rescore = inference->isReady() && inference->modelInfo().hasScores;
+
+    // 更新固定的 6 個格子，沒有結果的格子隱藏
+    for (int i = 0; i < summaryCells.size(); ++i) {
+        SummaryCell &cell = summaryCells[i];
+        QStringList parts = lines.value(i).split("|");
+        if (parts.size() < 4) {
+            cell.container->hide();
+            continue;
+        }
+
+        QString imageFile = parts[0].split(":").last().trimmed();
+        QString predictedClass = parts[0].split(":").last().trimmed();  // 獲取 Predicted Class
+        predictedClass.remove(".png");
+        QString result = parts[3].split(":").last().trimmed();
+
+        cell.numberLabel->setText(QString("第 %1 題").arg(i + 1));
+        cell.titleLabel->setText(QString("題目：%1").arg(predictedClass));
+
+        // 加載圖片
+        QString imagePath = QString("%1/%2").arg(resultFolderPath, imageFile);
+        const QImage drawing(imagePath);
+        if (!drawing.isNull()) {
+            cell.imageLabel->setPixmap(QPixmap::fromImage(drawing.scaled(200, 150, Qt::KeepAspectRatio)));
+        } else {
+            cell.imageLabel->setPixmap(QPixmap());
+            cell.imageLabel->setText("無法加載圖片");
+        }
+        cell.guessLabel->clear();
+        if (rescore && !drawing.isNull()) {
+            const quint64 id = Tracer::newSubmissionId();
+            rescoringCells.insert(id, i);
+            inference->classify(drawing, id, 0, InferenceScheduler::Background);
+        }
+
+        // 顯示答案標籤
+        cell.resultLabel->setText(result == "yes" ? "正確" : "錯誤");
+        cell.resultLabel->setStyleSheet(
+            result == "yes" ?
+                "font-size: 14px; "
+                "color: white; "
+                "background-color: green; "  // 正確顯示綠色背景
+                "border-radius: 5px; "
+                "padding: 8px;" :
+                "font-size: 14px; "
+                "color: white; "
+                "background-color: red; "  // 錯誤顯示紅色背景
+                "border-radius: 5px; "
+                "padding: 8px;"
+            );
+        cell.container->show();
+    }
+
+    qInfo().noquote() << resourceStats().toString();
+
+    span.reset();  // 追蹤只涵蓋更新畫面，不含玩家停留在總結頁的時間
+    setState(GameState::Summary);
+    summaryDialog->open();   // 視窗層級的 modal，不開啟巢狀事件迴圈；按鈕各自接手後續流程
+}
+
+
+// 建立可重複使用的「辨識中...」視窗，只在最後一題提交後、等待剩下的結果時顯示
+void MainWindow::buildProgressDialog() {
+    progressDialog = new QDialog(this);
+    progressDialog->setObjectName("progressDialog");
+    progressDialog->setWindowTitle("辨識中...");
+    progressDialog->resize(300, 100);
+
+    QVBoxLayout *layout = new QVBoxLayout(progressDialog);
+    QLabel *label = new QLabel("正在辨識圖片，請稍候...", progressDialog);
+    label->setAlignment(Qt::AlignCenter);
+    QProgressBar *progressBar = new QProgressBar(progressDialog);
+    progressBar->setRange(0, 0); // 無限進度模式
+    layout->addWidget(label);
+    layout->addWidget(progressBar);
+
+    progressDialog->setLayout(layout);
+    progressDialog->setModal(true);
+}
+
+
+// 建立可重複使用的總結視窗：固定 6 個格子，每局只更新內容
+void MainWindow::buildSummaryDialog() {
+    summaryDialog = new QDialog(this);
+    summaryDialog->setObjectName("summaryDialog");
+    summaryDialog->setWindowTitle("答題總結");
+    summaryDialog->resize(800, 600);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(summaryDialog);
+    QGridLayout *gridLayout = new QGridLayout();
+
+    for (int i = 0; i < questionsPerGame; ++i) {
+        SummaryCell cell;
+
+        cell.imageLabel = new QLabel(summaryDialog);
+        cell.imageLabel->setAlignment(Qt::AlignCenter);  // 圖片居中顯示
+
+        // 顯示題號標籤
+        cell.numberLabel = new QLabel(summaryDialog);
+        cell.numberLabel->setAlignment(Qt::AlignCenter);
+        cell.numberLabel->setStyleSheet(
+            "font-size: 16px; "
+            "font-weight: bold; "
+            "color: #4CAF50; "  // 顯示綠色
+            "padding: 8px; "
+            "border: 2px solid #4CAF50; "
+            "border-radius: 5px; "
+            "background-color: #e8f5e9;"  // 淺綠色背景
+            );
+
+        // 顯示題目名稱
+        cell.titleLabel = new QLabel(summaryDialog);
+        cell.titleLabel->setAlignment(Qt::AlignCenter);
+        cell.titleLabel->setStyleSheet(
+            "font-size: 14px; "
+            "font-weight: bold; "
+            "color: White; "  // 顯示深灰色字體
+            "padding: 5px;"
+            );
+
+        // 顯示答案標籤（顏色依結果在 showSummary 設定）
+        cell.resultLabel = new QLabel(summaryDialog);
+        cell.resultLabel->setAlignment(Qt::AlignCenter);
+
+        // 重新評分後的前三名猜測（onRescored 填入）
+        cell.guessLabel = new QLabel(summaryDialog);
+        cell.guessLabel->setAlignment(Qt::AlignCenter);
+        cell.guessLabel->setStyleSheet("font-size: 12px; color: white;");
+
+        // 外圍布局調整
+        QVBoxLayout *vLayout = new QVBoxLayout();
+        vLayout->addWidget(cell.numberLabel);
+        vLayout->addWidget(cell.titleLabel);
+        vLayout->addWidget(cell.imageLabel);
+        vLayout->addWidget(cell.resultLabel);
+        vLayout->addWidget(cell.guessLabel);
+        vLayout->setSpacing(10);  // 控制元素之間的間距
+        vLayout->setAlignment(Qt::AlignCenter);  // 垂直布局居中
+
+        // 外圍容器
+        cell.container = new QWidget(summaryDialog);
+        cell.container->setLayout(vLayout);
+        cell.container->hide();
+
+        // 添加到 Grid Layout 中
+        int row = i / 3;  // 行數
+        int col = i % 3;  // 列數
+        gridLayout->addWidget(cell.container, row, col);
+        summaryCells.append(cell);
+    }
+
+    mainLayout->addLayout(gridLayout);
+
+    // 添加按鈕
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *playAgainButton = new QPushButton("再玩一局", summaryDialog);
+    playAgainButton->setObjectName("playAgainButton");
+    playAgainButton->setStyleSheet("QPushButton {"
+                                   "border: 2px solid white;"   // 白色邊框
+                                   "background-color: yellow;"  // 黃色背景
+                                   "color: black;"              // 黑色文字
+                                   "font-size: 20px;"           // 文字大小
+                                   "padding: 5px 10px;"         // 按鈕內邊距
+                                   "border-radius: 5px;"        // 圓角邊框
+                                   "}");
+    QPushButton *exitButton = new QPushButton("結束遊戲", summaryDialog);
+    exitButton->setStyleSheet("QPushButton {"
+                              "border: 2px solid white;"   // 白色邊框
+                              "background-color: yellow;"  // 黃色背景
+                              "color: black;"              // 黑色文字
+                              "font-size: 20px;"           // 文字大小
+                              "padding: 5px 10px;"         // 按鈕內邊距
+                              "border-radius: 5px;"        // 圓角邊框
+                              "}");
+
+    connect(playAgainButton, &QPushButton::clicked, this, [this]() {
+        clearResults();  // 清空結果文件與資料夾
+        summaryDialog->accept();  // 關閉總結窗口
+        startGame();  // 開始新遊戲
+    });
+
+    // 結束遊戲
+    connect(exitButton, &QPushButton::clicked, this, [this]() {
+        clearResults();  // 清空結果文件與資料夾
+        QApplication::quit();  // 結束程式
+    });
+
+    // 關閉後釋放縮圖，總結頁不在畫面上時不佔記憶體
+    connect(summaryDialog, &QDialog::finished, this, [this]() {
+        for (SummaryCell &cell : summaryCells) {
+            cell.imageLabel->setPixmap(QPixmap());
+        }
+        rescoringCells.clear();   // 還在排隊的重新評分結果回來後直接丟棄
+        // 直接關閉總結頁（沒按任何按鈕）時回到開始畫面
+        if (state == GameState::Summary) {
+            setState(GameState::Idle);
+            startButton->show();
+        }
+    });
+
+    // 所有局的作品（歸檔在 historyDir），這一局在按下「再玩一局」後才會加入
+    QPushButton *historyButton = new QPushButton("歷史作品", summaryDialog);
+    historyButton->setStyleSheet(exitButton->styleSheet());
+    historyButton->setVisible(!config.historyDir.isEmpty());
+    connect(historyButton, &QPushButton::clicked, this, &MainWindow::showHistory);
+
+    buttonLayout->addWidget(playAgainButton);
+    buttonLayout->addWidget(historyButton);
+    buttonLayout->addWidget(exitButton);
+
+    mainLayout->addLayout(buttonLayout);
+}
+
+
+void MainWindow::setState(GameState next) {
+    if (state == next) {
+        return;
+    }
+    state = next;
+    emit gameStateChanged(next);
+}
+
+
+ResourceStats MainWindow::resourceStats() const {
+    return ResourceStats::collect(this);
+}
+
+
+void MainWindow::clearResults() {
+    // 先把舊資料改名移開（只是一次 rename，瞬間完成），真正的刪除交給背景執行緒
+    const QDateTime now = QDateTime::currentDateTime();
+    const QString suffix = ".trash-" + QString::number(now.toMSecsSinceEpoch());
+
+    // result.txt：改名後建立新的空檔案
+    const QString trashFile = resultFilePath + suffix;
+    const bool movedResultFile = QFile::rename(resultFilePath, trashFile);
+    QFile resultFile(resultFilePath);
+    if (resultFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        resultFile.close();  // WriteOnly 會截斷，得到空白的 result.txt
+    }
+
+    // resultfile 資料夾：整個改名移開後重建空資料夾
+    QString imageDir;   // 這一局的圖片所在
+    QDateTime cutoff;
+    QDir resultDir(resultFolderPath);
+    if (resultDir.exists()) {
+        QString trashDir = resultFolderPath + suffix;
+        if (QDir().rename(resultFolderPath, trashDir)) {
+            imageDir = trashDir;
+        } else {
+            // 資料夾被佔用（例如辨識程式正在寫入）無法改名時，
+            // 只在背景刪除此刻之前的檔案，避免誤刪新一局的圖片
+            imageDir = resultFolderPath;
+            cutoff = now;
+        }
+    }
+    QDir().mkpath(resultFolderPath);
+
+    // 背景執行緒先把這一局歸檔到歷史紀錄（搬走圖片），再刪除剩下的暫存
+    const QString historyDir = config.historyDir;
+    cleanupTasks.removeIf([](const QFuture<void> &task) { return task.isFinished(); });
+    cleanupTasks.append(QtConcurrent::run([trashFile, movedResultFile, imageDir, cutoff, historyDir]() {
+        if (movedResultFile && !imageDir.isEmpty() && !historyDir.isEmpty()) {
+            DrawingHistory::archiveRound(trashFile, imageDir, historyDir);
+        }
+        if (movedResultFile) {
+            purgePath(trashFile, QDateTime());
+        }
+        if (!imageDir.isEmpty()) {
+            purgePath(imageDir, cutoff);
+        }
+    }));
+}
+
+// 在背景執行緒刪除檔案或資料夾；cutoff 有效時只刪除該時間點之前修改的檔案
+void MainWindow::purgeInBackground(const QString &path, const QDateTime &cutoff) {
+    cleanupTasks.removeIf([](const QFuture<void> &task) { return task.isFinished(); });
+    cleanupTasks.append(QtConcurrent::run([path, cutoff]() { purgePath(path, cutoff); }));
+}
+
+
+// 歷史作品視窗第一次開啟時才建立，之後重複使用並重新讀取索引
+void MainWindow::showHistory() {
+    if (config.historyDir.isEmpty()) {
+        return;
+    }
+    if (!historyWindow) {
+        historyWindow = new HistoryWindow(config.historyDir, this);
+        historyWindow->setModal(true);   // 總結頁是 modal，從那裡開啟時也要能操作
+    } else {
+        historyWindow->reload();
+    }
+    historyWindow->show();
+    historyWindow->raise();
+}
+
+// 啟動時清除先前未刪完的 *.trash-* 暫存
+void MainWindow::sweepStaleTrash() {
+    QFileInfo resultInfo(resultFilePath);
+    QDir parentDir = resultInfo.absoluteDir();
+    if (!parentDir.exists()) {
+        return;
+    }
+    const QStringList filters = {resultInfo.fileName() + ".trash-*",
+                                 QFileInfo(resultFolderPath).fileName() + ".trash-*"};
+    for (const QFileInfo &fileInfo : parentDir.entryInfoList(filters, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot)) {
+        purgeInBackground(fileInfo.absoluteFilePath());
+    }
+}
@@ -1,90 +1,158 @@
-﻿#ifndef MAINWINDOW_H
-#define MAINWINDOW_H
-
-#include <QMainWindow>
-#include <QPainter>
-#include <QMouseEvent>
-#include <QColorDialog>
-#include <QVBoxLayout>
-#include <QHBoxLayout>
-#include <QPushButton>
-#include <QSlider>
-#include <QLabel>
-#include <QFileDialog>
-#include <QMessageBox>
-#include <QDir>
-#include <QDateTime>
-#include <QTimer>
-#include <cstdlib>
-#include <ctime> // 用於生成隨機數
-#include <random>
-#include <QGridLayout>
-#include <QLabel>
-#include <QProgressBar>
-#include <QApplication>
-
-
-class Canvas : public QWidget {
-    Q_OBJECT
-
-public:
-    explicit Canvas(QWidget *parent = nullptr);
-    void setBrushColor(const QColor &color);
-    void setBrushSize(int size);
-    void setEraser();
-    QPixmap getPixmap() const;
-    void clearCanvas();
-
-protected:
-    void mousePressEvent(QMouseEvent *event) override;
-    void mouseMoveEvent(QMouseEvent *event) override;
-    void mouseReleaseEvent(QMouseEvent *event) override;
-    void paintEvent(QPaintEvent *event) override;
-
-private:
-    QPixmap pixmap;
-    QColor brushColor;
-    int brushSize;
-    QPoint lastPos;
-    bool drawing;
-};
-
-class MainWindow : public QMainWindow {
-    Q_OBJECT
-
-public:
-    MainWindow(QWidget *parent = nullptr);
-    ~MainWindow();
-
-private slots:
-    void chooseColor();
-    void saveCanvas();
-    void monitorResultFile();
-    void startGame(); // 新增：啟動遊戲功能
-    void showNextQuestion(); // 在這裡宣告函數
-    void showSummary();
-    void clearResults();
-    void onTimeOut();
-    void updateTimer();
-
-private:
-    Canvas *canvas;
-    QString resultFilePath;
-    QTimer *fileCheckTimer;
-    QVBoxLayout *mainLayout;
-    QHBoxLayout *controls;
-    QPushButton *startButton;   // "開始遊戲" 按鈕
-    QLabel *questionLabel;      // 顯示題目
-    QStringList questionPool;   // 題目池
-    QString currentQuestion;    // 當前題目
-    QStringList questionQueue;   // 保存隨機排列的6個題目
-    int currentQuestionIndex;    // 當前題目的索引
-    QTimer *delayTimer; // 用於保存後延遲處理
-    QLabel *timeLabel; // 用於顯示倒計時
-    QTimer *questionTimer; // 每題計時器
-    int remainingTime; // 剩餘時間（秒）
-    const int questionTimeLimit = 30; // 每一題限時（秒）
-
-};
-
-#endif // MAINWINDOW_H
+﻿#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QColorDialog>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QSlider>
+#include <QLabel>
+#include <QFileDialog>
+#include <QDir>
+#include <QDateTime>
+#include <QTimer>
+#include <cstdlib>
+#include <ctime> // 用於生成隨機數
+#include <random>
+#include <QGridLayout>
+#include <QLabel>
+#include <QProgressBar>
+#include <QApplication>
+#include <QFuture>
+#include <QQueue>
+#include "appconfig.h"
+#include "canvas.h"
+#include "inferenceservice.h"
+#include "latencystats.h"
+#include "resourcestats.h"
+#include "toast.h"
+#include "tracer.h"
+
+class HistoryWindow;
+
+
+class MainWindow : public QMainWindow {
+    Q_OBJECT
+
+public:
+    // 遊戲流程：每個階段只由計時器與辨識結果推進，不開啟巢狀事件迴圈
+    enum class GameState {
+        Idle,        // 尚未開始或一局結束後關閉總結頁
+        Drawing,     // 作畫中，倒數計時；前幾題的辨識可能還在進行
+        Submitting,  // 最後一題已提交，等待剩下的辨識結果
+        Result,      // 最後一題的對錯停留一下再顯示總結
+        Summary      // 總結頁
+    };
+    Q_ENUM(GameState)
+
+    explicit MainWindow(const AppConfig &config = AppConfig::load(), QWidget *parent = nullptr);
+    ~MainWindow();
+
+    ResourceStats resourceStats() const;
+    GameState gameState() const { return state; }
+
+signals:
+    void gameStateChanged(MainWindow::GameState state);
+    // 顯示對錯時發出；submittedMicros 為提交時間（epoch 微秒），背景辨識提前答對時為 0
+    void answerShown(bool correct, qint64 submittedMicros);
+
+private slots:
+    void chooseColor();
+    void saveCanvas();
+    void startGame(); // 新增：啟動遊戲功能
+    void showNextQuestion(); // 在這裡宣告函數
+    void showSummary();
+    void clearResults();
+    void updateTimer();
+    void onModelReady(bool ok, const QString &message);
+    void onClassified(const Prediction &prediction);
+    void requestPreview();
+    void onPreviewClassified(const Prediction &prediction);
+    void onRescored(const Prediction &prediction);
+    void showHistory();
+
+private:
+    void showResult(const QString &question, bool correct, qint64 submittedMicros = 0);
+    void finishEarly(const Prediction &prediction);
+    void saveRecording();
+    void updateQuestionPool();
+    void appendResultLine(const QString &imageFile, const Prediction &prediction, bool correct);
+    void flushHeldResults();
+    void purgeInBackground(const QString &path, const QDateTime &cutoff = QDateTime());
+    void sweepStaleTrash();
+    void buildProgressDialog();
+    void buildSummaryDialog();
+    void setState(GameState next);
+
+    // 已提交、還在辨識的一題；畫布緩衝由辨識用完後還給 Canvas
+    struct PendingSubmission {
+        quint64 id = 0;
+        int questionIndex = 0;   // 本局的第幾題（從 0 起算）
+        QString question;
+        Canvas::Frame frame;
+        qint64 saveStartMicros = 0;
+        qint64 encodeDoneMicros = 0;
+        qint64 fileWrittenMicros = 0;
+    };
+
+    // 提前答對、還不能寫入 result.txt 的結果
+    struct HeldResult {
+        int questionIndex;
+        QString imageFile;
+        Prediction prediction;
+    };
+
+    // 總結頁的一個格子，重複使用以避免每局重建
+    struct SummaryCell {
+        QWidget *container;
+        QLabel *numberLabel;
+        QLabel *titleLabel;
+        QLabel *imageLabel;
+        QLabel *resultLabel;
+        QLabel *guessLabel;
+    };
+
+    AppConfig config;
+    GameState state = GameState::Idle;
+    InferenceService *inference; // 程序內模型；未就緒時改走 Python 辨識流程
+    QDialog *progressDialog;          // 「辨識中...」視窗
+    QDialog *summaryDialog;           // 答題總結視窗
+    Toast *toast;                     // 時間到、對錯等提示，自動消失
+    QVector<SummaryCell> summaryCells;
+    QHash<quint64, int> rescoringCells;   // 重新評分的編號 → 格子
+    HistoryWindow *historyWindow = nullptr;   // 歷史作品，第一次開啟時建立
+    SubmissionLatency latency;        // 每次提交各階段的延遲統計
+    QQueue<PendingSubmission> pendingSubmissions;   // 依提交順序，辨識與下一題的作畫同時進行
+    QVector<HeldResult> heldResults;  // 依題號排列，前面的題目都寫入 result.txt 後才追加
+    QTimer *previewTimer;             // 提前結束：定期背景辨識目前的畫布
+    quint64 questionSequence = 0;     // 每出一題遞增，不依賴牆上時鐘
+    QHash<quint64, quint64> previewQuestions;   // 預覽的編號 → 送出時的 questionSequence，其他題的結果直接丟棄
+    quint64 revisionAtQuestionStart = 0;
+    quint64 lastPreviewRevision = 0;  // 上一次送出預覽時的畫布版本，每次評估都是不同的畫布
+    int targetClassIndex = -1;        // 目前題目在模型輸出中的索引
+    int confidentStreak = 0;          // 連續達標次數
+    Canvas *canvas;
+    QString resultFilePath;
+    QString resultFolderPath;
+    QList<QFuture<void>> cleanupTasks; // 背景清理工作，解構時等待完成
+    QVBoxLayout *mainLayout;
+    QHBoxLayout *controls;
+    QPushButton *startButton;   // "開始遊戲" 按鈕
+    QLabel *questionLabel;      // 顯示題目
+    QStringList questionPool;   // 題目池（取自標籤檔）
+    QString currentQuestion;    // 當前題目
+    QStringList questionQueue;   // 保存隨機排列的6個題目
+    int currentQuestionIndex;    // 當前題目的索引
+    QTimer *delayTimer; // 顯示結果後延遲進入下一題
+    QLabel *timeLabel; // 用於顯示倒計時
+    QTimer *questionTimer; // 每題計時器
+    int remainingTime; // 剩餘時間（秒）
+    const int questionTimeLimit = 30; // 每一題限時（秒）
+    const int questionsPerGame = 6;   // 每局題數
+
+};
+
+#endif // MAINWINDOW_H
@@ -0,0 +1,98 @@
+﻿#include "mockclassifier.h"
+#include "latencystats.h"
+#include "predictioncache.h"
+#include <QTimer>
+
+namespace {
+// splitmix64：把雜湊打散成均勻分布的亂數
+quint64 mix(quint64 value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+double unit(quint64 value) {
+    return double(value >> 11) / double(1ULL << 53);
+}
+}
+
+MockClassifier::MockClassifier(const Options &options, QObject *parent)
+    : Classifier(parent), options(options) {}
+
+void MockClassifier::start() {
+    QString error;
+    labelList = InferenceEngine::loadLabels(options.labelsPath, &error);
+    started = !labelList.isEmpty();
+    QTimer::singleShot(0, this, [this, error]() {
+        if (!started) {
+            emit ready(false, error.isEmpty() ? "標籤檔沒有任何類別：" + options.labelsPath : error);
+            return;
+        }
+        emit ready(true, QString("使用 mock 辨識後端（%1 類，延遲 %2 ms，正確率 %3）")
+                             .arg(labelList.size()).arg(options.latencyMs).arg(options.accuracy));
+    });
+}
+
+bool MockClassifier::isReady() const {
+    return started;
+}
+
+Classifier::ModelInfo MockClassifier::modelInfo() const {
+    ModelInfo info;
+    info.backend = "mock";
+    info.cacheable = false;
+    info.description = QString("mock（延遲 %1 ms）").arg(options.latencyMs);
+    info.labels = labelList;
+    info.inputSize = InferenceEngine::InputSize;
+    info.hasScores = true;
+    return info;
+}
+
+// 同一批一起回覆，延遲取批次中最長的一張
+QVector<quint64> MockClassifier::classifyBatch(const QVector<QImage> &images, const QVector<quint64> &) {
+    QVector<quint64> requestIds;
+    QVector<Prediction> predictions;
+    int delayMs = options.latencyMs;
+    const qint64 started = SubmissionLatency::nowMicros();
+    for (const QImage &image : images) {
+        requestIds.append(newRequestId());
+        Prediction prediction = predict(image);
+        prediction.startedMicros = started;
+        predictions.append(prediction);
+        if (options.jitterMs > 0) {
+            const quint64 hash = mix(PredictionCache::dHash(image));
+            delayMs = qMax(delayMs, options.latencyMs + int(hash % quint64(options.jitterMs + 1)));
+        }
+    }
+    QTimer::singleShot(delayMs, this, [this, requestIds, predictions]() mutable {
+        const qint64 finished = SubmissionLatency::nowMicros();
+        for (int i = 0; i < requestIds.size(); ++i) {
+            predictions[i].finishedMicros = finished;
+            emit classified(requestIds[i], predictions[i]);
+        }
+    });
+    return requestIds;
+}
+
+Prediction MockClassifier::predict(const QImage &image) const {
+    const QString question = image.text("Question").toLower();
+    const quint64 seed = mix(PredictionCache::dHash(image) ^ qHash(question));
+    const int classCount = labelList.size();
+
+    Prediction prediction;
+    const int questionIndex = labelList.indexOf(question);
+    if (questionIndex >= 0 && unit(seed) < options.accuracy) {
+        prediction.classIndex = questionIndex;
+    } else {
+        prediction.classIndex = int(mix(seed) % quint64(classCount));
+    }
+    prediction.label = labelList[prediction.classIndex];
+    prediction.confidence = float(0.5 + 0.5 * unit(mix(seed ^ 1)));
+
+    // 其餘機率平均分給其他類別，總和為 1
+    const float rest = classCount > 1 ? (1.0f - prediction.confidence) / (classCount - 1) : 0.0f;
+    prediction.scores.fill(rest, classCount);
+    prediction.scores[prediction.classIndex] = prediction.confidence;
+    return prediction;
+}
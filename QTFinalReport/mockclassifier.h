@@ -0,0 +1,39 @@
+﻿#ifndef MOCKCLASSIFIER_H
+#define MOCKCLASSIFIER_H
+
+#include "classifier.h"
+
+// 不需要模型與 Python 的替身後端，供 soak 測試與基準測試隔離出 GUI 本身的成本
+// 結果只由影像內容（dHash）與題目決定：同一張圖永遠得到相同答案
+// 影像帶有 Question 欄位且在標籤中時，約 accuracy 比例回答題目本身，其餘依雜湊挑一個類別
+// 標籤與輸入大小與程序內模型相同，前處理與結果對應走同一條路徑
+// 答案還取決於題目，只以像素計算的快取鍵分不出來，因此回報 cacheable = false
+// 沒有模型可重新載入，reload() 沿用基底類別回報不支援
+// 延遲以計時器模擬，不佔用任何執行緒
+class MockClassifier : public Classifier {
+    Q_OBJECT
+
+public:
+    struct Options {
+        int latencyMs = 20;
+        int jitterMs = 0;          // 依影像雜湊額外增加 0 ~ jitterMs
+        double accuracy = 0.8;
+        QString labelsPath;        // 與模型相同的標籤檔，start() 時載入
+    };
+
+    explicit MockClassifier(const Options &options, QObject *parent = nullptr);
+
+    void start() override;
+    bool isReady() const override;
+    ModelInfo modelInfo() const override;
+    QVector<quint64> classifyBatch(const QVector<QImage> &images, const QVector<quint64> &submissionIds) override;
+
+    Prediction predict(const QImage &image) const;
+
+private:
+    Options options;
+    QStringList labelList;
+    bool started = false;
+};
+
+#endif // MOCKCLASSIFIER_H
@@ -0,0 +1,49 @@
+﻿#include "modelfilewatcher.h"
+#include <QFileInfo>
+
+ModelFileWatcher::ModelFileWatcher(const QStringList &files, int debounceMs, QObject *parent)
+    : QObject(parent), files(files) {
+    watcher = new QFileSystemWatcher(this);
+    debounce = new QTimer(this);
+    debounce->setSingleShot(true);
+    debounce->setInterval(debounceMs);
+
+    connect(watcher, &QFileSystemWatcher::fileChanged, debounce, qOverload<>(&QTimer::start));
+    connect(watcher, &QFileSystemWatcher::directoryChanged, debounce, qOverload<>(&QTimer::start));
+    connect(debounce, &QTimer::timeout, this, &ModelFileWatcher::settle);
+
+    for (const QString &file : files) {
+        watcher->addPath(QFileInfo(file).absolutePath());
+    }
+    watchFiles();
+    lastSignature = signature();
+}
+
+void ModelFileWatcher::watchFiles() {
+    const QStringList watched = watcher->files();
+    for (const QString &file : files) {
+        if (!watched.contains(file) && QFileInfo::exists(file)) {
+            watcher->addPath(file);
+        }
+    }
+}
+
+// 資料夾內其他檔案變動也會觸發，只有模型或標籤的大小、修改時間改變才發出 changed
+void ModelFileWatcher::settle() {
+    watchFiles();
+    const QString current = signature();
+    if (current == lastSignature) {
+        return;
+    }
+    lastSignature = current;
+    emit changed();
+}
+
+QString ModelFileWatcher::signature() const {
+    QStringList parts;
+    for (const QString &file : files) {
+        const QFileInfo info(file);
+        parts << QString("%1:%2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+    }
+    return parts.join('|');
+}
@@ -0,0 +1,33 @@
+﻿#ifndef MODELFILEWATCHER_H
+#define MODELFILEWATCHER_H
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+// 監看模型與標籤檔，內容穩定後發出 changed
+// 部署工具常以「寫到暫存檔再改名」的方式覆蓋檔案，被取代的檔案會從 QFileSystemWatcher 消失，
+// 因此同時監看所在資料夾，並在每次變動後重新加入檔案；寫入期間的連續事件以 debounce 合併
+class ModelFileWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    ModelFileWatcher(const QStringList &files, int debounceMs = 1000, QObject *parent = nullptr);
+
+signals:
+    void changed();
+
+private:
+    void watchFiles();
+    void settle();
+    QString signature() const;
+
+    QStringList files;
+    QFileSystemWatcher *watcher;
+    QTimer *debounce;
+    QString lastSignature;
+};
+
+#endif // MODELFILEWATCHER_H
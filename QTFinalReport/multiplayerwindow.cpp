@@ -0,0 +1,154 @@
+﻿#include "multiplayerwindow.h"
+#include "tracer.h"
+#include <QDebug>
+#include <QGridLayout>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <random>
+
+MultiplayerWindow::MultiplayerWindow(int players, const AppConfig &config, QWidget *parent)
+    : QMainWindow(parent), config(config) {
+    players = qBound(2, players, 4);
+    inference = new InferenceService(this);
+    connect(inference, &InferenceService::modelReady, this, &MultiplayerWindow::onModelReady);
+    connect(inference, &InferenceService::classified, this, &MultiplayerWindow::onClassified);
+    connect(inference, &InferenceService::modelReloaded, this, [](bool ok, const QString &message) {
+        if (ok) {
+            qInfo().noquote() << message;
+        } else {
+            qWarning().noquote() << message;
+        }
+    });
+
+    promptLabel = new QLabel("題目：", this);
+    promptLabel->setAlignment(Qt::AlignCenter);
+    QFont font = promptLabel->font();
+    font.setPointSize(30);
+    font.setBold(true);
+    promptLabel->setFont(font);
+
+    startButton = new QPushButton("模型載入中...", this);
+    startButton->setStyleSheet("QPushButton {"
+                               "border: 2px solid white;"
+                               "background-color: yellow;"
+                               "color: black;"
+                               "font-size: 40px;"
+                               "padding: 5px 10px;"
+                               "border-radius: 5px;"
+                               "}");
+    startButton->setEnabled(false);
+    connect(startButton, &QPushButton::clicked, this, &MultiplayerWindow::startGame);
+
+    // 兩人左右並排，三、四人排成 2x2
+    auto *grid = new QGridLayout();
+    const QSize canvasSize = players == 2 ? QSize(600, 450) : QSize(560, 300);
+    for (int i = 0; i < players; ++i) {
+        auto *panel = new PlayerPanel(i, canvasSize, config.grayscaleCanvas, this);
+        connect(panel, &PlayerPanel::submitted, this, &MultiplayerWindow::onSubmitted);
+        connect(panel, &PlayerPanel::roundFinished, this, &MultiplayerWindow::onRoundFinished);
+        grid->addWidget(panel, i / 2, i % 2);
+        panels.append(panel);
+    }
+    pendingRounds.resize(players);
+
+    auto *centralWidget = new QWidget();
+    auto *layout = new QVBoxLayout(centralWidget);
+    layout->addWidget(promptLabel);
+    layout->addLayout(grid);
+    layout->addWidget(startButton, 0, Qt::AlignCenter);
+    setCentralWidget(centralWidget);
+    setWindowTitle(QString("小畫家 - %1 人對戰").arg(players));
+    toast = new Toast(this);
+
+    inference->start(config);
+}
+
+void MultiplayerWindow::onModelReady(bool ok, const QString &message) {
+    if (!ok || inference->modelInfo().writesResultFile) {
+        // 檔案交換的 Python 流程一次只能辨識一張圖，多人模式需要程序內模型或辨識伺服器
+        qWarning().noquote() << "多人模式無法使用：" + message;
+        startButton->setText("需要程序內模型或辨識伺服器");
+        startButton->setEnabled(false);
+        return;
+    }
+    qDebug() << message;
+    startButton->setText("開始遊戲");
+    startButton->setEnabled(true);
+}
+
+void MultiplayerWindow::startGame() {
+    startButton->hide();
+    questionPool = inference->labels();   // 每局取自目前的模型，熱更新後下一局生效
+    std::random_device rd;
+    std::mt19937 g(rd());
+    std::shuffle(questionPool.begin(), questionPool.end(), g);
+    questionQueue = questionPool.mid(0, questionsPerGame);
+    for (PlayerPanel *panel : panels) {
+        panel->resetScore();
+    }
+    round = 0;
+    nextRound();
+}
+
+void MultiplayerWindow::nextRound() {
+    advancing = false;
+    if (round >= questionQueue.size()) {
+        showFinalScores();
+        return;
+    }
+    currentQuestion = questionQueue[round++];
+    promptLabel->setText(QString("題目：%1（%2/%3）").arg(currentQuestion).arg(round).arg(questionQueue.size()));
+    for (PlayerPanel *panel : panels) {
+        panel->startRound(questionTimeLimit);
+    }
+}
+
+void MultiplayerWindow::onSubmitted(int player, const QImage &drawing) {
+    pendingRounds[player].enqueue(round);
+    inference->classify(drawing, Tracer::newSubmissionId(), player);
+}
+
+void MultiplayerWindow::onClassified(const Prediction &prediction, int player) {
+    if (player < 0 || player >= panels.size() || pendingRounds[player].isEmpty()) {
+        return;
+    }
+    // 同一位玩家的結果依提交順序回來；上一題的遲到結果直接丟棄
+    if (pendingRounds[player].dequeue() != round) {
+        return;
+    }
+    const bool correct = prediction.isValid() && prediction.label == currentQuestion.toLower();
+    panels[player]->showResult(prediction, correct);
+}
+
+void MultiplayerWindow::onRoundFinished() {
+    if (advancing) {
+        return;
+    }
+    for (PlayerPanel *panel : panels) {
+        if (!panel->isRoundFinished()) {
+            return;
+        }
+    }
+    advancing = true;
+    QTimer::singleShot(config.resultDisplayMs, this, &MultiplayerWindow::nextRound);   // 停留一下讓大家看到結果
+}
+
+void MultiplayerWindow::showFinalScores() {
+    QVector<PlayerPanel *> ranking = panels;
+    std::stable_sort(ranking.begin(), ranking.end(),
+                     [](const PlayerPanel *a, const PlayerPanel *b) { return a->score() > b->score(); });
+    QStringList lines;
+    for (const PlayerPanel *panel : ranking) {
+        lines << QString("玩家 %1：%2 分").arg(panel->player() + 1).arg(panel->score());
+    }
+    // 排名留在提示列直到下一局開始；提示訊息只宣布第一名，停留時間與顯示結果相同
+    promptLabel->setText("遊戲結束　" + lines.join("｜"));
+    if (!ranking.isEmpty()) {
+        const bool tie = ranking.size() > 1 && ranking[1]->score() == ranking[0]->score();
+        toast->showMessage(tie ? QString("平手！") : QString("玩家 %1 獲勝！").arg(ranking[0]->player() + 1),
+                           Toast::Info, config.resultDisplayMs);
+    }
+    startButton->setText("再玩一次");
+    startButton->show();
+}
@@ -0,0 +1,50 @@
+﻿#ifndef MULTIPLAYERWINDOW_H
+#define MULTIPLAYERWINDOW_H
+
+#include "appconfig.h"
+#include "inferenceservice.h"
+#include "playerpanel.h"
+#include "toast.h"
+#include <QLabel>
+#include <QMainWindow>
+#include <QPushButton>
+#include <QQueue>
+#include <QVector>
+
+// 同一台觸控螢幕上 2~4 位玩家同時畫同一個題目
+// 所有玩家共用一個 InferenceService（一份模型、一條推理執行緒），由其輪流制佇列保證公平
+// 一題在每位玩家都答對或時間到後結束，短暫停留顯示結果再進下一題
+class MultiplayerWindow : public QMainWindow {
+    Q_OBJECT
+
+public:
+    explicit MultiplayerWindow(int players, const AppConfig &config = AppConfig::load(), QWidget *parent = nullptr);
+
+private slots:
+    void startGame();
+    void nextRound();
+    void onModelReady(bool ok, const QString &message);
+    void onSubmitted(int player, const QImage &drawing);
+    void onClassified(const Prediction &prediction, int player);
+    void onRoundFinished();
+
+private:
+    void showFinalScores();
+
+    AppConfig config;
+    InferenceService *inference;
+    QLabel *promptLabel;
+    Toast *toast;                  // 宣布第一名，不擋住畫面
+    QPushButton *startButton;
+    QVector<PlayerPanel *> panels;
+    QVector<QQueue<int>> pendingRounds;   // 每位玩家尚未回覆的提交各屬於第幾題
+    QStringList questionPool;
+    QStringList questionQueue;
+    QString currentQuestion;
+    int round = 0;
+    bool advancing = false;
+    int questionTimeLimit = 30;
+    int questionsPerGame = 6;
+};
+
+#endif // MULTIPLAYERWINDOW_H
@@ -0,0 +1,140 @@
+﻿#include "playerpanel.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+namespace {
+const char *buttonStyle = "QPushButton {"
+                          "border: 2px solid white;"
+                          "background-color: yellow;"
+                          "color: black;"
+                          "font-size: 20px;"
+                          "padding: 5px 10px;"
+                          "border-radius: 5px;"
+                          "}";
+}
+
+PlayerPanel::PlayerPanel(int player, const QSize &canvasSize, bool grayscale, QWidget *parent)
+    : QWidget(parent), playerIndex(player) {
+    setObjectName(QString("player%1").arg(player + 1));
+
+    titleLabel = new QLabel(this);
+    QFont font = titleLabel->font();
+    font.setPointSize(18);
+    font.setBold(true);
+    titleLabel->setFont(font);
+
+    timeLabel = new QLabel(this);
+    timeLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    timeLabel->setStyleSheet("font-size: 20px;");
+
+    statusLabel = new QLabel(this);
+    statusLabel->setAlignment(Qt::AlignCenter);
+    statusLabel->setStyleSheet("font-size: 18px;");
+
+    canvas = new Canvas(this);
+    canvas->setCanvasSize(canvasSize);
+    canvas->setGrayscale(grayscale);
+    canvas->setModelInputSize(InferenceEngine::InputSize);
+
+    submitButton = new QPushButton("提交", this);
+    submitButton->setStyleSheet(buttonStyle);
+    connect(submitButton, &QPushButton::clicked, this, &PlayerPanel::submit);
+
+    clearButton = new QPushButton("清除畫布", this);
+    clearButton->setStyleSheet(buttonStyle);
+    connect(clearButton, &QPushButton::clicked, canvas, &Canvas::clearCanvas);
+
+    countdown = new QTimer(this);
+    connect(countdown, &QTimer::timeout, this, &PlayerPanel::tick);
+
+    auto *header = new QHBoxLayout();
+    header->addWidget(titleLabel);
+    header->addWidget(timeLabel);
+
+    auto *buttons = new QHBoxLayout();
+    buttons->addWidget(submitButton);
+    buttons->addWidget(clearButton);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(header);
+    layout->addWidget(canvas, 0, Qt::AlignCenter);
+    layout->addWidget(statusLabel);
+    layout->addLayout(buttons);
+
+    submitButton->setEnabled(false);
+    updateTitle();
+}
+
+int PlayerPanel::player() const {
+    return playerIndex;
+}
+
+int PlayerPanel::score() const {
+    return points;
+}
+
+bool PlayerPanel::isRoundFinished() const {
+    return finished;
+}
+
+void PlayerPanel::resetScore() {
+    points = 0;
+    updateTitle();
+}
+
+void PlayerPanel::startRound(int timeLimit) {
+    finished = false;
+    remainingTime = timeLimit;
+    canvas->clearCanvas();
+    statusLabel->clear();
+    statusLabel->setStyleSheet("font-size: 18px;");
+    timeLabel->setText(QString("倒數 %1").arg(remainingTime));
+    submitButton->setEnabled(true);
+    countdown->start(1000);
+}
+
+void PlayerPanel::showResult(const Prediction &prediction, bool correct) {
+    if (finished) {
+        return;   // 時間到之後才回來的結果不計分
+    }
+    if (correct) {
+        ++points;
+        updateTitle();
+        finishRound("正確！", "green");
+        return;
+    }
+    statusLabel->setText(prediction.isValid() ? QString("看起來像 %1，再試一次").arg(prediction.label)
+                                              : QString("辨識失敗，再試一次"));
+    submitButton->setEnabled(true);
+}
+
+void PlayerPanel::submit() {
+    if (finished) {
+        return;
+    }
+    submitButton->setEnabled(false);
+    statusLabel->setText("辨識中...");
+    emit submitted(playerIndex, canvas->modelImage());   // 已是模型解析度，辨識時不必再縮放
+}
+
+void PlayerPanel::tick() {
+    --remainingTime;
+    timeLabel->setText(QString("倒數 %1").arg(remainingTime));
+    if (remainingTime <= 0) {
+        finishRound("時間到", "gray");
+    }
+}
+
+void PlayerPanel::finishRound(const QString &status, const QString &color) {
+    finished = true;
+    countdown->stop();
+    submitButton->setEnabled(false);
+    statusLabel->setText(status);
+    statusLabel->setStyleSheet(QString("font-size: 18px; color: white; background-color: %1; border-radius: 5px;")
+                                   .arg(color));
+    emit roundFinished(playerIndex);
+}
+
+void PlayerPanel::updateTitle() {
+    titleLabel->setText(QString("玩家 %1：%2 分").arg(playerIndex + 1).arg(points));
+}
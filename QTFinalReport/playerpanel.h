@@ -0,0 +1,50 @@
+﻿#ifndef PLAYERPANEL_H
+#define PLAYERPANEL_H
+
+#include "canvas.h"
+#include "inferenceengine.h"
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+#include <QWidget>
+
+// 分割畫面中一位玩家的區塊：自己的畫布、倒數計時、提交與清除按鈕
+// 提交後畫布仍可繼續作畫，辨識結果回來前只停用提交按鈕
+class PlayerPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    PlayerPanel(int player, const QSize &canvasSize, bool grayscale, QWidget *parent = nullptr);
+
+    int player() const;
+    int score() const;
+    bool isRoundFinished() const;
+
+    void resetScore();
+    void startRound(int timeLimit);
+    void showResult(const Prediction &prediction, bool correct);
+
+signals:
+    void submitted(int player, const QImage &drawing);
+    void roundFinished(int player);
+
+private:
+    void submit();
+    void tick();
+    void finishRound(const QString &status, const QString &color);
+    void updateTitle();
+
+    int playerIndex;
+    int points = 0;
+    int remainingTime = 0;
+    bool finished = true;
+    QLabel *titleLabel;
+    QLabel *timeLabel;
+    QLabel *statusLabel;
+    Canvas *canvas;
+    QPushButton *submitButton;
+    QPushButton *clearButton;
+    QTimer *countdown;
+};
+
+#endif // PLAYERPANEL_H
@@ -0,0 +1,92 @@
+﻿#include "predictioncache.h"
+#include <QtAlgorithms>
+
+PredictionCache::PredictionCache(int capacity, int maxDistance)
+    : capacity(qMax(0, capacity)), maxDistance(qMax(0, maxDistance)) {
+}
+
+quint64 PredictionCache::dHash(const QImage &image) {
+    // 平滑縮放以區域平均取樣，細筆畫也會反映在灰階上
+    const QImage small = image.scaled(9, 8, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                             .convertToFormat(QImage::Format_Grayscale8);
+    quint64 hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        const uchar *row = small.constScanLine(y);
+        for (int x = 0; x < 8; ++x) {
+            hash = (hash << 1) | (row[x] > row[x + 1] ? 1 : 0);
+        }
+    }
+    return hash;
+}
+
+bool PredictionCache::lookup(quint64 hash, Prediction *prediction) {
+    QMutexLocker locker(&mutex);
+    auto best = entries.end();
+    int bestDistance = maxDistance + 1;
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        const int distance = int(qPopulationCount(it->hash ^ hash));
+        if (distance < bestDistance) {
+            best = it;
+            bestDistance = distance;
+            if (distance == 0) {
+                break;
+            }
+        }
+    }
+    if (best == entries.end()) {
+        ++missCount;
+        return false;
+    }
+    ++hitCount;
+    entries.splice(entries.begin(), entries, best);
+    *prediction = entries.front().prediction;
+    return true;
+}
+
+void PredictionCache::insert(quint64 hash, const Prediction &prediction) {
+    if (capacity == 0 || !prediction.isValid()) {
+        return;
+    }
+    QMutexLocker locker(&mutex);
+    // 同一個鍵已在快取中（兩個相同的請求都未命中）就更新結果並移到最前面，不留重複的項目
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->hash == hash) {
+            it->prediction = prediction;
+            entries.splice(entries.begin(), entries, it);
+            return;
+        }
+    }
+    entries.push_front({hash, prediction});
+    if (int(entries.size()) > capacity) {
+        entries.pop_back();
+    }
+}
+
+void PredictionCache::clear() {
+    QMutexLocker locker(&mutex);
+    entries.clear();
+}
+
+qint64 PredictionCache::hits() const {
+    QMutexLocker locker(&mutex);
+    return hitCount;
+}
+
+qint64 PredictionCache::misses() const {
+    QMutexLocker locker(&mutex);
+    return missCount;
+}
+
+double PredictionCache::hitRate() const {
+    QMutexLocker locker(&mutex);
+    const qint64 total = hitCount + missCount;
+    return total ? double(hitCount) / total : 0.0;
+}
+
+QString PredictionCache::summaryLine() const {
+    QMutexLocker locker(&mutex);
+    const qint64 total = hitCount + missCount;
+    return QString("cache: %1/%2 hits (%3%), %4/%5 entries, max distance %6")
+        .arg(hitCount).arg(total).arg(total ? 100.0 * hitCount / total : 0.0, 0, 'f', 1)
+        .arg(entries.size()).arg(capacity).arg(maxDistance);
+}
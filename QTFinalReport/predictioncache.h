@@ -0,0 +1,44 @@
+﻿#ifndef PREDICTIONCACHE_H
+#define PREDICTIONCACHE_H
+
+#include "inferenceengine.h"
+#include <QMutex>
+#include <QString>
+#include <list>
+
+// 以感知雜湊（dHash）為鍵的辨識結果快取
+// 幾乎相同的畫布（重複提交、沒有新筆畫的即時猜測）雜湊距離很小，直接回傳上次的結果，不必再跑模型
+// 容量小（預設 256），查詢時線性比對 Hamming 距離並取最接近者；命中的項目移到最前面，滿了淘汰最久未用的
+// 可由多個執行緒同時使用
+class PredictionCache {
+public:
+    explicit PredictionCache(int capacity = 256, int maxDistance = 3);
+
+    // 64 位元 dHash：縮成 9x8 灰階，每列相鄰像素左亮於右記 1
+    static quint64 dHash(const QImage &image);
+
+    bool isEnabled() const { return capacity > 0; }
+    bool lookup(quint64 hash, Prediction *prediction);
+    void insert(quint64 hash, const Prediction &prediction);
+    void clear();
+
+    qint64 hits() const;
+    qint64 misses() const;
+    double hitRate() const;
+    QString summaryLine() const;
+
+private:
+    struct Entry {
+        quint64 hash;
+        Prediction prediction;
+    };
+
+    const int capacity;
+    const int maxDistance;
+    mutable QMutex mutex;
+    std::list<Entry> entries;   // 最近使用的在前
+    qint64 hitCount = 0;
+    qint64 missCount = 0;
+};
+
+#endif // PREDICTIONCACHE_H
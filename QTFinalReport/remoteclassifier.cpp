@@ -0,0 +1,58 @@
+﻿#include "remoteclassifier.h"
+#include "inferenceclient.h"
+
+RemoteClassifier::RemoteClassifier(const QString &serverName, int timeoutMs, QObject *parent)
+    : Classifier(parent), serverName(serverName), client(new InferenceClient(this)) {
+    client->setRequestTimeout(timeoutMs);
+    connect(client, &InferenceClient::ready, this, [this]() {
+        emit ready(true, QString("已連線到辨識伺服器 %1").arg(this->serverName));
+    });
+    connect(client, &InferenceClient::connectionFailed, this, [this](const QString &message) {
+        emit ready(false, message);
+    });
+    connect(client, &InferenceClient::disconnected, this, [this]() {
+        emit ready(false, "與辨識伺服器的連線中斷");
+    });
+    connect(client, &InferenceClient::labelsChanged, this, [this]() {
+        emit reloaded(true, "辨識伺服器已換用新模型");
+    });
+    // 斷線或逾時的請求會收到無效的結果
+    connect(client, &InferenceClient::classified, this, [this](quint64 requestId, const Prediction &prediction, int) {
+        emit classified(requestId, prediction);
+    });
+}
+
+void RemoteClassifier::start() {
+    client->connectToServer(serverName);
+}
+
+// 伺服器載入完成後重送 Hello，由 labelsChanged 通知
+void RemoteClassifier::reload() {
+    client->requestReload();
+}
+
+bool RemoteClassifier::isReady() const {
+    return client->isReady();
+}
+
+Classifier::ModelInfo RemoteClassifier::modelInfo() const {
+    ModelInfo info;
+    info.backend = "server";
+    info.description = "辨識伺服器 " + serverName;
+    info.labels = client->labels();
+    info.inputSize = InferenceEngine::InputSize;
+    info.hasScores = true;
+    info.maxInFlight = client->maxBatch();   // 多位玩家同時提交時一起送出，伺服器才湊得成一批
+    return info;
+}
+
+// requestId 直接沿用 InferenceClient 的編號；伺服器會把同時送達的請求併成一批
+QVector<quint64> RemoteClassifier::classifyBatch(const QVector<QImage> &images, const QVector<quint64> &submissionIds) {
+    QVector<quint64> requestIds;
+    for (int i = 0; i < images.size(); ++i) {
+        const QImage &image = images[i];
+        const bool prepared = image.width() == InferenceEngine::InputSize && image.height() == InferenceEngine::InputSize;
+        requestIds.append(client->classify(prepared ? image : InferenceEngine::preprocess(image), submissionIds.value(i)));
+    }
+    return requestIds;
+}
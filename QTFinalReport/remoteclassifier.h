@@ -0,0 +1,26 @@
+﻿#ifndef REMOTECLASSIFIER_H
+#define REMOTECLASSIFIER_H
+
+#include "classifier.h"
+
+class InferenceClient;
+
+// 連線到 InferenceServer（QTFinalReport --server），本機只做前處理
+class RemoteClassifier : public Classifier {
+    Q_OBJECT
+
+public:
+    RemoteClassifier(const QString &serverName, int timeoutMs, QObject *parent = nullptr);
+
+    void start() override;
+    void reload() override;
+    bool isReady() const override;
+    ModelInfo modelInfo() const override;
+    QVector<quint64> classifyBatch(const QVector<QImage> &images, const QVector<quint64> &submissionIds) override;
+
+private:
+    QString serverName;
+    InferenceClient *client;
+};
+
+#endif // REMOTECLASSIFIER_H
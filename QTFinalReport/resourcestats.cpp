@@ -0,0 +1,34 @@
+﻿#include "resourcestats.h"
+#include "canvas.h"
+#include <QApplication>
+#include <QLabel>
+
+namespace {
+qint64 pixmapBytes(const QPixmap &pixmap) {
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+}
+
+ResourceStats ResourceStats::collect(const QObject *root) {
+    ResourceStats stats;
+    stats.objects = root->findChildren<QObject *>().size() + 1;
+    stats.widgets = QApplication::allWidgets().size();
+
+    for (const QLabel *label : root->findChildren<QLabel *>()) {
+        const QPixmap pixmap = label->pixmap();
+        if (!pixmap.isNull()) {
+            ++stats.pixmaps;
+            stats.pixmapBytes += pixmapBytes(pixmap);
+        }
+    }
+    for (const Canvas *canvas : root->findChildren<Canvas *>()) {
+        ++stats.pixmaps;
+        stats.pixmapBytes += canvas->image().sizeInBytes();   // 灰階畫布每像素 1 byte
+    }
+    return stats;
+}
+
+QString ResourceStats::toString() const {
+    return QString("resources objects=%1 widgets=%2 pixmaps=%3 pixmapBytes=%4")
+        .arg(objects).arg(widgets).arg(pixmaps).arg(pixmapBytes);
+}
@@ -0,0 +1,18 @@
+﻿#ifndef RESOURCESTATS_H
+#define RESOURCESTATS_H
+
+#include <QObject>
+#include <QString>
+
+// 目前持有的資源：用來確認長時間運作時記憶體與元件數維持平穩
+struct ResourceStats {
+    int objects = 0;          // root 之下（含 root）的 QObject 數
+    int widgets = 0;          // 整個程式的 QWidget 數
+    int pixmaps = 0;          // root 之下標籤與畫布持有的點陣圖數
+    qint64 pixmapBytes = 0;   // 上述點陣圖佔用的位元組
+
+    static ResourceStats collect(const QObject *root);
+    QString toString() const;
+};
+
+#endif // RESOURCESTATS_H
@@ -0,0 +1,259 @@
+﻿#include "strokerecording.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+namespace {
+const char Magic[4] = {'Q', 'D', 'S', 'R'};
+constexpr quint8 FormatVersion = 1;
+
+void writeVarint(QByteArray &out, quint64 value) {
+    while (value >= 0x80) {
+        out.append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+void writeSigned(QByteArray &out, qint64 value) {
+    writeVarint(out, (quint64(value) << 1) ^ quint64(value >> 63));   // zigzag：小的負數也只佔一個 byte
+}
+
+class Reader {
+public:
+    explicit Reader(const QByteArray &data) : data(data) {}
+
+    bool ok() const { return !failed; }
+    bool atEnd() const { return offset >= data.size(); }
+
+    quint64 varint() {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (offset >= data.size()) {
+                break;
+            }
+            const quint8 byte = quint8(data[offset++]);
+            value |= quint64(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+
+    qint64 signedVarint() {
+        const quint64 value = varint();
+        return qint64(value >> 1) ^ -qint64(value & 1);
+    }
+
+    QByteArray bytes(qsizetype size) {
+        if (size < 0 || offset + size > data.size()) {
+            failed = true;
+            return QByteArray();
+        }
+        const QByteArray result = data.mid(offset, size);
+        offset += size;
+        return result;
+    }
+
+private:
+    const QByteArray &data;
+    qsizetype offset = 0;
+    bool failed = false;
+};
+}
+
+quint32 StrokeRecording::durationMs() const {
+    quint32 duration = 0;
+    for (const Stroke &stroke : strokes) {
+        duration = qMax(duration, stroke.isClear() ? stroke.timeMs : stroke.points.last().timeMs);
+    }
+    return duration;
+}
+
+QByteArray StrokeRecording::encode() const {
+    QByteArray out;
+    out.append(Magic, sizeof(Magic));
+    out.append(char(FormatVersion));
+    writeVarint(out, quint64(qMax(0, canvasSize.width())));
+    writeVarint(out, quint64(qMax(0, canvasSize.height())));
+    const QByteArray labelUtf8 = label.toUtf8();
+    writeVarint(out, quint64(labelUtf8.size()));
+    out.append(labelUtf8);
+    writeVarint(out, quint64(qMax<qint64>(0, startedMsecs)));
+    writeVarint(out, quint64(strokes.size()));
+
+    // 筆畫依開始時間排列；座標與時間都對前一個事件取差
+    QPoint lastPos;
+    quint32 lastTime = 0;
+    for (const Stroke &stroke : strokes) {
+        writeVarint(out, quint64(stroke.points.size()));
+        writeSigned(out, qint64(stroke.timeMs) - lastTime);
+        lastTime = stroke.timeMs;
+        if (stroke.isClear()) {
+            continue;
+        }
+        writeVarint(out, stroke.color.rgba());
+        writeVarint(out, quint64(qMax(0, stroke.width)));
+        for (const Point &point : stroke.points) {
+            writeSigned(out, point.pos.x() - lastPos.x());
+            writeSigned(out, point.pos.y() - lastPos.y());
+            writeSigned(out, qint64(point.timeMs) - lastTime);
+            lastPos = point.pos;
+            lastTime = point.timeMs;
+        }
+    }
+    return out;
+}
+
+bool StrokeRecording::decode(const QByteArray &data, StrokeRecording *recording, QString *errorString) {
+    const auto fail = [errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        return false;
+    };
+    if (data.size() < 5 || !data.startsWith(QByteArray(Magic, sizeof(Magic)))) {
+        return fail("不是筆畫錄製檔");
+    }
+    if (quint8(data[4]) != FormatVersion) {
+        return fail(QString("不支援的錄製格式版本 %1").arg(quint8(data[4])));
+    }
+
+    Reader in(data);
+    in.bytes(5);
+    StrokeRecording result;
+    const int width = int(in.varint());
+    const int height = int(in.varint());
+    result.canvasSize = QSize(width, height);
+    result.label = QString::fromUtf8(in.bytes(qsizetype(in.varint())));
+    result.startedMsecs = qint64(in.varint());
+    const quint64 strokeCount = in.varint();
+
+    QPoint lastPos;
+    qint64 lastTime = 0;
+    for (quint64 i = 0; i < strokeCount && in.ok(); ++i) {
+        Stroke stroke;
+        const quint64 pointCount = in.varint();
+        lastTime += in.signedVarint();
+        stroke.timeMs = quint32(qMax<qint64>(0, lastTime));
+        if (pointCount > 0) {
+            stroke.color = QColor::fromRgba(QRgb(in.varint()));
+            stroke.width = int(in.varint());
+            if (pointCount > quint64(data.size())) {   // 每點至少 3 bytes，超過檔案大小必定損壞
+                return fail("筆畫點數不正確");
+            }
+            stroke.points.reserve(int(pointCount));
+            for (quint64 p = 0; p < pointCount && in.ok(); ++p) {
+                const int dx = int(in.signedVarint());
+                const int dy = int(in.signedVarint());
+                lastTime += in.signedVarint();
+                lastPos += QPoint(dx, dy);
+                stroke.points.append({lastPos, quint32(qMax<qint64>(0, lastTime))});
+            }
+        }
+        result.strokes.append(stroke);
+    }
+    if (!in.ok()) {
+        return fail("錄製檔被截斷");
+    }
+    *recording = result;
+    return true;
+}
+
+bool StrokeRecording::appendTo(const QString &path) const {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::Append)) {
+        return false;
+    }
+    const QByteArray payload = encode();
+    QByteArray record;
+    writeVarint(record, quint64(payload.size()));
+    record.append(payload);
+    return file.write(record) == record.size();
+}
+
+QVector<StrokeRecording> StrokeRecording::readAll(const QString &path, QString *errorString) {
+    QVector<StrokeRecording> recordings;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = "無法開啟 " + path;
+        }
+        return recordings;
+    }
+    const QByteArray data = file.readAll();
+    Reader in(data);
+    while (!in.atEnd()) {
+        const QByteArray payload = in.bytes(qsizetype(in.varint()));
+        StrokeRecording recording;
+        if (!in.ok() || !decode(payload, &recording, errorString)) {
+            break;   // 最後一筆可能寫到一半（程式被中斷），保留前面完整的部分
+        }
+        recordings.append(recording);
+    }
+    return recordings;
+}
+
+void StrokeRecorder::start(const QSize &canvasSize, const QString &label) {
+    current = StrokeRecording();
+    current.canvasSize = canvasSize;
+    current.label = label;
+    current.startedMsecs = QDateTime::currentMSecsSinceEpoch();
+    activeStrokes.clear();
+    clock.start();
+    recording = true;
+}
+
+void StrokeRecorder::stop() {
+    recording = false;
+    activeStrokes.clear();
+}
+
+void StrokeRecorder::beginStroke(int id, const QPoint &pos, const QColor &color, int width) {
+    if (!recording) {
+        return;
+    }
+    StrokeRecording::Stroke stroke;
+    stroke.color = color;
+    stroke.width = width;
+    stroke.timeMs = now();
+    stroke.points.append({pos, stroke.timeMs});
+    activeStrokes.insert(id, current.strokes.size());
+    current.strokes.append(stroke);
+}
+
+void StrokeRecorder::addPoint(int id, const QPoint &pos) {
+    const auto it = activeStrokes.constFind(id);
+    if (!recording || it == activeStrokes.constEnd()) {
+        return;
+    }
+    current.strokes[it.value()].points.append({pos, now()});
+}
+
+void StrokeRecorder::endStroke(int id) {
+    activeStrokes.remove(id);
+}
+
+void StrokeRecorder::clear() {
+    if (!recording) {
+        return;
+    }
+    StrokeRecording::Stroke marker;
+    marker.timeMs = now();
+    current.strokes.append(marker);
+    activeStrokes.clear();
+}
+
+StrokeRecording StrokeRecorder::take() {
+    stop();
+    StrokeRecording result = current;
+    current = StrokeRecording();
+    return result;
+}
+
+quint32 StrokeRecorder::now() const {
+    return quint32(clock.elapsed());
+}
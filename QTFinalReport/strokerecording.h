@@ -0,0 +1,72 @@
+﻿#ifndef STROKERECORDING_H
+#define STROKERECORDING_H
+
+#include <QColor>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QIODevice>
+#include <QPoint>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+// 一題的作畫過程：每一筆的顏色、粗細與帶時間的座標點，以及清除畫布的時間點
+// 二進位格式（小端、varint）：
+//   "QDSR" 版本(1) | 畫布寬 高 | 題目 | 開始時間(epoch ms) | 筆畫數 | 每筆：
+//     點數 | dt | 點數 > 0 時：顏色 ARGB、粗細、各點 (dx, dy, dt)
+//   座標以 zigzag varint 記錄與前一點的差，時間以 varint 記錄與前一個事件的差（毫秒）
+//   點數 0 表示清除畫布；一般筆畫每點約 3 bytes
+struct StrokeRecording {
+    struct Point {
+        QPoint pos;
+        quint32 timeMs = 0;   // 自開始錄製起算
+    };
+    struct Stroke {
+        QColor color;
+        int width = 0;
+        QVector<Point> points;   // 空的代表清除畫布
+        quint32 timeMs = 0;      // 開始時間（清除畫布的時間）
+        bool isClear() const { return points.isEmpty(); }
+    };
+
+    QSize canvasSize;
+    QString label;
+    qint64 startedMsecs = 0;
+    QVector<Stroke> strokes;
+
+    bool isEmpty() const { return strokes.isEmpty(); }
+    quint32 durationMs() const;
+
+    QByteArray encode() const;
+    static bool decode(const QByteArray &data, StrokeRecording *recording, QString *errorString = nullptr);
+
+    // 一天的錄製附加在同一個檔案：每筆以 varint 長度開頭
+    bool appendTo(const QString &path) const;
+    static QVector<StrokeRecording> readAll(const QString &path, QString *errorString = nullptr);
+};
+
+// 記錄 Canvas 上的輸入；觸控可能同時有多筆，以輸入點 id 區分（滑鼠固定為 -1）
+class StrokeRecorder {
+public:
+    void start(const QSize &canvasSize, const QString &label);
+    void stop();
+    bool isRecording() const { return recording; }
+
+    void beginStroke(int id, const QPoint &pos, const QColor &color, int width);
+    void addPoint(int id, const QPoint &pos);
+    void endStroke(int id);
+    void clear();
+
+    StrokeRecording take();   // 取出並停止錄製
+
+private:
+    quint32 now() const;
+
+    bool recording = false;
+    StrokeRecording current;
+    QElapsedTimer clock;
+    QHash<int, int> activeStrokes;   // 輸入點 id → strokes 索引
+};
+
+#endif // STROKERECORDING_H
@@ -0,0 +1,51 @@
+﻿#ifndef STROKEREPLAYER_H
+#define STROKEREPLAYER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "strokerecording.h"
+
+class Canvas;
+
+// 依錄製的時間軸把筆畫畫回 Canvas
+// speed 1 為原速、2 為兩倍速；0 表示立即畫完（例如產生錯誤回報的截圖）
+// 畫布大小與錄製時不同時按比例縮放
+class StrokeReplayer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StrokeReplayer(Canvas *canvas, QObject *parent = nullptr);
+
+    void play(const StrokeRecording &recording, double speed = 1.0);
+    void stop();
+    bool isPlaying() const;
+
+signals:
+    void finished();
+
+private:
+    // 一個事件是某筆畫的第 point 點（point 0 只定位不畫線）或清除畫布
+    struct Event {
+        quint32 timeMs;
+        int stroke;
+        int point;
+    };
+
+    void advance();
+    void apply(const Event &event);
+    QPoint mapped(const QPoint &pos) const;
+
+    Canvas *canvas;
+    QTimer *frameTimer;
+    QElapsedTimer clock;
+    StrokeRecording recording;
+    QVector<Event> events;
+    int nextEvent = 0;
+    double speed = 1.0;
+    double scaleX = 1.0;
+    double scaleY = 1.0;
+};
+
+#endif // STROKEREPLAYER_H
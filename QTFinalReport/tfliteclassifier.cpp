@@ -0,0 +1,225 @@
+﻿#include "tfliteclassifier.h"
+#include "inferencetuner.h"
+#include "latencystats.h"
+#include "modelfilewatcher.h"
+#include "tracer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+struct LoadResult {
+    std::shared_ptr<InferenceEngine> engine;   // 失敗時為 nullptr
+    InferenceEngine::Options options;
+    QString message;
+};
+
+LoadResult loadEngine(const AppConfig &config, const InferenceEngine::Options &options) {
+    LoadResult result;
+    result.options = options;
+    QElapsedTimer timer;
+    timer.start();
+    result.engine = InferenceEngine::loadAndWarmUp(config.modelPath, config.labelsPath, result.options,
+                                                   config.warmupRuns, 1, &result.message);
+    if (result.engine) {
+        result.message = QString("模型已就緒（%1 類，%2，載入並暖機 %3 次 %4 ms）")
+                             .arg(result.engine->labels().size()).arg(result.options.describe())
+                             .arg(config.warmupRuns).arg(timer.elapsed());
+    }
+    return result;
+}
+}
+
+TfliteClassifier::TfliteClassifier(const AppConfig &config, QObject *parent)
+    : Classifier(parent), config(config), engine(std::make_shared<InferenceEngine>()) {
+    worker.setMaxThreadCount(1);
+    worker.setExpiryTimeout(-1);  // 執行緒常駐，避免每次推理重新建立
+}
+
+TfliteClassifier::~TfliteClassifier() {
+    worker.waitForDone();
+}
+
+void TfliteClassifier::start() {
+    auto *watcher = new QFutureWatcher<LoadResult>(this);
+    connect(watcher, &QFutureWatcher<LoadResult>::finished, this, [this, watcher]() {
+        const LoadResult result = watcher->result();
+        watcher->deleteLater();
+        loaded = bool(result.engine);
+        if (loaded) {
+            engine = result.engine;
+            options = result.options;
+            if (config.watchModel) {
+                auto *fileWatcher = new ModelFileWatcher({config.modelPath, config.labelsPath}, 1000, this);
+                connect(fileWatcher, &ModelFileWatcher::changed, this, &TfliteClassifier::reload);
+            }
+        }
+        emit ready(loaded, result.message);
+    });
+
+    const AppConfig loadConfig = config;
+    watcher->setFuture(QtConcurrent::run(&worker, [loadConfig]() {
+        QString tuningReport;
+        const InferenceEngine::Options options = engineOptions(loadConfig, &tuningReport);
+        if (!tuningReport.isEmpty()) {
+            qInfo().noquote() << tuningReport;
+        }
+        return loadEngine(loadConfig, options);
+    }));
+}
+
+// 在另一條執行緒載入新模型，推理照常進行；載入完成才替換
+// 已排入 worker 的推理持有舊引擎的 shared_ptr，會在舊模型上完成，之後的請求使用新模型
+// 沿用目前的推理設定而不重新調校：調校會佔滿 CPU 數秒，拖慢進行中的即時辨識；新模型留到下次啟動再調校
+void TfliteClassifier::reload() {
+    if (!loaded) {
+        return;
+    }
+    if (reloading) {
+        reloadPending = true;   // 載入途中檔案又變了，完成後再載一次
+        return;
+    }
+    reloading = true;
+
+    auto *watcher = new QFutureWatcher<LoadResult>(this);
+    connect(watcher, &QFutureWatcher<LoadResult>::finished, this, [this, watcher]() {
+        const LoadResult result = watcher->result();
+        watcher->deleteLater();
+        reloading = false;
+        if (result.engine) {
+            engine = result.engine;
+            options = result.options;
+            emit reloaded(true, "已換用新模型：" + result.message);
+        } else {
+            emit reloaded(false, "新模型無法載入，繼續使用目前的模型：" + result.message);
+        }
+        if (reloadPending) {
+            reloadPending = false;
+            reload();
+        }
+    });
+
+    const AppConfig loadConfig = config;
+    const InferenceEngine::Options currentOptions = options;
+    watcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(), [loadConfig, currentOptions]() {
+        return loadEngine(loadConfig, currentOptions);
+    }));
+}
+
+bool TfliteClassifier::isReady() const {
+    return loaded;
+}
+
+Classifier::ModelInfo TfliteClassifier::modelInfo() const {
+    ModelInfo info;
+    info.backend = "tflite";
+    info.description = QString("%1（%2）").arg(config.modelPath, options.describe());
+    info.labels = loaded ? engine->labels() : QStringList();
+    info.inputSize = InferenceEngine::InputSize;
+    info.hasScores = true;
+    return info;
+}
+
+// 整批一次推理；已是 224x224 的輸入前處理只做格式轉換
+QVector<quint64> TfliteClassifier::classifyBatch(const QVector<QImage> &images, const QVector<quint64> &submissionIds) {
+    QVector<quint64> requestIds;
+    for (int i = 0; i < images.size(); ++i) {
+        requestIds.append(newRequestId());
+    }
+    if (images.isEmpty()) {
+        return requestIds;
+    }
+
+    auto *watcher = new QFutureWatcher<QVector<Prediction>>(this);
+    connect(watcher, &QFutureWatcher<QVector<Prediction>>::finished, this, [this, watcher, requestIds]() {
+        const QVector<Prediction> predictions = watcher->result();
+        watcher->deleteLater();
+        for (int i = 0; i < requestIds.size(); ++i) {
+            emit classified(requestIds[i], predictions.value(i));
+        }
+    });
+
+    std::shared_ptr<InferenceEngine> target = engine;
+    const quint64 traceId = images.size() == 1 ? submissionIds.value(0) : 0;
+    watcher->setFuture(QtConcurrent::run(&worker, [target, images, submissionIds, traceId]() {
+        const qint64 started = SubmissionLatency::nowMicros();
+        QVector<QImage> modelImages;
+        for (int i = 0; i < images.size(); ++i) {
+            TraceSpan span("preprocess", submissionIds.value(i));
+            modelImages.append(InferenceEngine::preprocess(images[i]));
+        }
+
+        QVector<Prediction> predictions;
+        bool ok;
+        {
+            TraceSpan span("set_input", traceId);
+            ok = target->setInput(modelImages);
+        }
+        if (ok) {
+            TraceSpan span("invoke", traceId);
+            ok = target->invoke();
+        }
+        if (ok) {
+            TraceSpan span("postprocess", traceId);
+            for (const QVector<float> &scores : target->outputs()) {
+                predictions.append(target->postprocess(scores));
+            }
+        }
+        const qint64 finished = SubmissionLatency::nowMicros();
+        predictions.resize(images.size());   // 失敗時補上無效的結果
+        for (Prediction &prediction : predictions) {
+            prediction.startedMicros = started;
+            prediction.finishedMicros = finished;
+        }
+        return predictions;
+    }));
+    return requestIds;
+}
+
+InferenceEngine::Options TfliteClassifier::engineOptions(const AppConfig &config, QString *report) {
+    const bool autoThreads = config.inferenceThreads <= 0;
+    const bool autoDelegate = config.inferenceDelegate == "auto";
+    InferenceEngine::Options options;
+    options.numThreads = autoThreads ? 1 : config.inferenceThreads;
+    options.xnnpack = config.inferenceDelegate == "xnnpack";
+    if (!autoThreads && !autoDelegate) {
+        return options;
+    }
+
+    // 同一個模型、同一台機器、同樣的自動項目已調校過就直接沿用
+    const QString signature = InferenceTuner::signature(config.modelPath);
+    const QString mode = QString("threads=%1 delegate=%2")
+                             .arg(autoThreads ? "auto" : QString::number(config.inferenceThreads), config.inferenceDelegate);
+    AppConfig::EngineTuning tuning = AppConfig::loadTuning();
+    if (tuning.signature != signature || tuning.mode != mode) {
+        QElapsedTimer timer;
+        timer.start();
+        const QVector<InferenceTuner::Trial> trials = InferenceTuner::run(
+            config.modelPath, config.labelsPath, InferenceTuner::candidates(autoThreads, autoDelegate, options));
+        const int best = InferenceTuner::fastest(trials);
+        if (best < 0) {
+            return options;   // 模型無法載入，交給呼叫端回報錯誤
+        }
+        tuning.signature = signature;
+        tuning.mode = mode;
+        tuning.threads = trials[best].options.numThreads;
+        tuning.xnnpack = trials[best].options.xnnpack;
+        tuning.medianMs = trials[best].medianMs;
+        const bool saved = AppConfig::saveTuning(tuning);
+        if (report) {
+            *report = QString("推理設定自動調校（%1 ms）：\n%2")
+                          .arg(QString::number(timer.elapsed()), InferenceTuner::report(trials));
+            if (!saved) {
+                *report += "\n（調校結果無法寫入 " + AppConfig::tuningCachePath() + "）";
+            }
+        }
+    }
+    if (autoThreads) {
+        options.numThreads = tuning.threads;
+    }
+    if (autoDelegate) {
+        options.xnnpack = tuning.xnnpack;
+    }
+    return options;
+}
@@ -0,0 +1,38 @@
+﻿#ifndef TFLITECLASSIFIER_H
+#define TFLITECLASSIFIER_H
+
+#include "classifier.h"
+#include <QThreadPool>
+#include <memory>
+
+// 程序內的 TensorFlow Lite 模型
+// 載入、暖機與推理都在一條常駐的專用執行緒上，因此 InferenceEngine 不會被同時使用
+// 模型或標籤檔更新時（config.watchModel）或呼叫 reload() 時在背景載入新模型，成功後才替換（沿用目前的推理設定）
+class TfliteClassifier : public Classifier {
+    Q_OBJECT
+
+public:
+    explicit TfliteClassifier(const AppConfig &config, QObject *parent = nullptr);
+    ~TfliteClassifier() override;
+
+    void start() override;
+    void reload() override;
+    bool isReady() const override;
+    ModelInfo modelInfo() const override;
+    QVector<quint64> classifyBatch(const QVector<QImage> &images, const QVector<quint64> &submissionIds) override;
+
+    // 依設定決定執行緒數與是否使用 XNNPACK；設為自動且沒有適用的調校結果時先調校並存入調校快取
+    // 調校需數秒，只能在背景執行緒或沒有視窗的伺服器模式呼叫
+    static InferenceEngine::Options engineOptions(const AppConfig &config, QString *report = nullptr);
+
+private:
+    AppConfig config;
+    QThreadPool worker;
+    std::shared_ptr<InferenceEngine> engine;
+    InferenceEngine::Options options;
+    bool loaded = false;
+    bool reloading = false;
+    bool reloadPending = false;
+};
+
+#endif // TFLITECLASSIFIER_H
@@ -0,0 +1,46 @@
+﻿#include "toast.h"
+#include <QEvent>
+#include <QTimer>
+
+Toast::Toast(QWidget *parent)
+    : QLabel(parent), hideTimer(new QTimer(this)) {
+    setObjectName("toast");
+    setAlignment(Qt::AlignCenter);
+    setWordWrap(true);
+    setAttribute(Qt::WA_TransparentForMouseEvents);   // 不攔截滑鼠，提示顯示時仍可繼續作畫
+    hideTimer->setSingleShot(true);
+    connect(hideTimer, &QTimer::timeout, this, &QWidget::hide);
+    parent->installEventFilter(this);   // 父視窗改變大小時重新置中
+    hide();
+}
+
+void Toast::showMessage(const QString &text, Style style, int durationMs) {
+    static const char *backgrounds[] = {"#424242", "#2e7d32", "#e65100", "#c62828"};
+    setStyleSheet(QString("font-size: 28px; "
+                          "font-weight: bold; "
+                          "color: white; "
+                          "background-color: %1; "
+                          "border-radius: 10px; "
+                          "padding: 12px 24px;").arg(backgrounds[style]));
+    setText(text);
+    reposition();
+    show();
+    raise();
+    hideTimer->start(qMax(0, durationMs));
+    emit messageShown(text, style);
+}
+
+bool Toast::eventFilter(QObject *watched, QEvent *event) {
+    if (watched == parent() && event->type() == QEvent::Resize && isVisible()) {
+        reposition();
+    }
+    return QLabel::eventFilter(watched, event);
+}
+
+// 水平置中，放在父視窗上方四分之一處，不蓋住畫布中央
+void Toast::reposition() {
+    const QWidget *area = parentWidget();
+    setMaximumWidth(qMax(200, area->width() * 3 / 4));
+    adjustSize();
+    move((area->width() - width()) / 2, area->height() / 4 - height() / 2);
+}
@@ -0,0 +1,33 @@
+﻿#ifndef TOAST_H
+#define TOAST_H
+
+#include <QLabel>
+
+class QTimer;
+
+// 不擋住操作的提示訊息：疊在父視窗上方，時間到自動隱藏，取代會開啟巢狀事件迴圈的 QMessageBox
+// 每個視窗只建立一個並重複使用，新訊息直接取代目前顯示的訊息
+class Toast : public QLabel {
+    Q_OBJECT
+
+public:
+    enum Style { Info, Success, Warning, Error };
+    Q_ENUM(Style)
+
+    explicit Toast(QWidget *parent);
+
+    void showMessage(const QString &text, Style style = Info, int durationMs = 1500);
+
+signals:
+    void messageShown(const QString &text, Toast::Style style);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void reposition();
+
+    QTimer *hideTimer;
+};
+
+#endif // TOAST_H
@@ -0,0 +1,363 @@
+﻿// 批次評分工具
+//
+// 遞迴掃描資料夾中的圖片，以與遊戲相同的 InferenceEngine（前處理 + 模型）平行辨識，
+// 每張圖完成後立即輸出一筆紀錄（JSON Lines 或 CSV），定期在 stderr 顯示進度與吞吐量，
+// 結束時輸出整體與各類別的準確率。適合整夜驗證收集到的玩家作品。
+//
+// 正確答案的推斷：上層資料夾名稱是類別名稱時使用之（例如 cat/0001.png），
+// 否則使用去掉尾端編號的檔名（例如遊戲存下的 cat.png、cat_12.png）；都不符合時不計入準確率。
+//
+// 用法：
+//   ./quickdraw-score --model model_unquant.tflite --labels labels.txt drawings/ [more/ ...]
+//       [--workers 8] [--intra-threads 1] [--xnnpack] [--batch 8] [--top 3]
+//       [--format jsonl|csv] [--output results.jsonl] [--progress-ms 2000]
+//
+// 每個 worker 各載入一份模型（InferenceEngine 非執行緒安全），記憶體用量約為模型大小 × worker 數。
+
+#include "inferenceengine.h"
+#include "latencystats.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <atomic>
+
+struct Record {
+    QString path;
+    QString expected;
+    Prediction prediction;
+    QVector<int> top;
+    QString error;
+    double decodeMs = 0.0;
+    double inferMs = 0.0;    // 一批的推理時間平均到每張
+};
+
+// 所有 worker 共用的輸出：逐筆寫出、統計並定期回報進度
+class RecordSink {
+public:
+    RecordSink(QFile *output, bool csv, int total, int progressMs, const QStringList &labels)
+        : output(output), csv(csv), total(total), progressMs(progressMs), labels(labels) {
+        clock.start();
+        progressClock.start();
+        if (csv) {
+            output->write("path,expected,label,confidence,correct,top,decode_ms,infer_ms,error\r\n");
+        }
+    }
+
+    void write(const QVector<Record> &records) {
+        QMutexLocker locker(&mutex);
+        for (const Record &record : records) {
+            const bool known = !record.expected.isEmpty() && record.error.isEmpty();
+            const bool correct = known && record.prediction.label == record.expected;
+            ++done;
+            if (!record.error.isEmpty()) {
+                ++errors;
+            } else {
+                decodeLatency.record(qint64(record.decodeMs * 1000));
+                inferLatency.record(qint64(record.inferMs * 1000));
+            }
+            if (known) {
+                ++scored;
+                correctCount += correct;
+                PerClass &stats = perClass[record.expected];
+                ++stats.total;
+                stats.correct += correct;
+            }
+            output->write(csv ? csvLine(record, known, correct) : jsonLine(record, known, correct));
+        }
+        output->flush();
+
+        if (progressMs > 0 && progressClock.elapsed() >= progressMs) {
+            progressClock.restart();
+            qInfo().noquote() << QString("%1/%2 (%3 img/s)").arg(done).arg(total).arg(throughput(), 0, 'f', 1);
+        }
+    }
+
+    QJsonObject summary() const {
+        QMutexLocker locker(&mutex);
+        QJsonObject classes;
+        for (auto it = perClass.constBegin(); it != perClass.constEnd(); ++it) {
+            classes[it.key()] = QJsonObject{{"total", it->total},
+                                            {"accuracy", double(it->correct) / it->total}};
+        }
+        const auto latency = [](const LatencyHistogram &histogram) {
+            return QJsonObject{{"p50", histogram.percentile(50) / 1000.0},
+                               {"p99", histogram.percentile(99) / 1000.0},
+                               {"max", histogram.max() / 1000.0}};
+        };
+        QJsonObject result;
+        result["images"] = done;
+        result["errors"] = errors;
+        result["elapsedSec"] = clock.elapsed() / 1000.0;
+        result["imagesPerSec"] = throughput();
+        result["scored"] = scored;
+        result["accuracy"] = scored ? double(correctCount) / scored : 0.0;
+        result["decodeMs"] = latency(decodeLatency);
+        result["inferMs"] = latency(inferLatency);
+        result["classes"] = classes;
+        return result;
+    }
+
+private:
+    struct PerClass {
+        int total = 0;
+        int correct = 0;
+    };
+
+    double throughput() const {
+        const qint64 elapsed = clock.elapsed();
+        return elapsed > 0 ? done * 1000.0 / elapsed : 0.0;
+    }
+
+    QByteArray jsonLine(const Record &record, bool known, bool correct) const {
+        QJsonObject object;
+        object["path"] = record.path;
+        if (!record.error.isEmpty()) {
+            object["error"] = record.error;
+            return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+        }
+        object["label"] = record.prediction.label;
+        object["confidence"] = record.prediction.confidence;
+        if (known) {
+            object["expected"] = record.expected;
+            object["correct"] = correct;
+        }
+        QJsonArray top;
+        for (int index : record.top) {
+            top.append(QJsonObject{{"label", labels.value(index)}, {"score", record.prediction.scores.value(index)}});
+        }
+        object["top"] = top;
+        object["decodeMs"] = record.decodeMs;
+        object["inferMs"] = record.inferMs;
+        return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    QByteArray csvLine(const Record &record, bool known, bool correct) const {
+        QStringList top;
+        for (int index : record.top) {
+            top << labels.value(index);
+        }
+        const QStringList fields = {
+            csvField(record.path),
+            csvField(record.expected),
+            csvField(record.prediction.label),
+            record.error.isEmpty() ? QString::number(record.prediction.confidence) : QString(),
+            known ? QString(correct ? "1" : "0") : QString(),
+            csvField(top.join(' ')),
+            QString::number(record.decodeMs, 'f', 3),
+            QString::number(record.inferMs, 'f', 3),
+            csvField(record.error),
+        };
+        return (fields.join(',') + "\r\n").toUtf8();
+    }
+
+    // RFC 4180：含逗號、雙引號或換行的欄位以雙引號包住，內部的雙引號寫成兩個；記錄以 CRLF 結尾
+    // 標籤來自 labels.txt 與檔名，可能含任何字元
+    static QString csvField(QString text) {
+        static const QRegularExpression special("[\",\r\n]");
+        if (!text.contains(special)) {
+            return text;
+        }
+        return '"' + text.replace('"', "\"\"") + '"';
+    }
+
+    QFile *output;
+    bool csv;
+    int total;
+    int progressMs;
+    QStringList labels;
+    mutable QMutex mutex;
+    QElapsedTimer clock;
+    QElapsedTimer progressClock;
+    int done = 0;
+    int errors = 0;
+    int scored = 0;
+    int correctCount = 0;
+    QMap<QString, PerClass> perClass;
+    LatencyHistogram decodeLatency;
+    LatencyHistogram inferLatency;
+};
+
+static QStringList collectImages(const QStringList &roots) {
+    QStringList paths;
+    for (const QString &root : roots) {
+        if (QFileInfo(root).isFile()) {
+            paths << root;
+            continue;
+        }
+        QDirIterator it(root, {"*.png", "*.jpg", "*.jpeg"}, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            paths << it.next();
+        }
+    }
+    paths.sort();
+    return paths;
+}
+
+static QString expectedLabel(const QString &path, const QSet<QString> &labels) {
+    const QFileInfo info(path);
+    const QString folder = info.dir().dirName().toLower();
+    if (labels.contains(folder)) {
+        return folder;
+    }
+    static const QRegularExpression numberSuffix("[_\\-\\s]*\\d+$");
+    const QString stem = info.completeBaseName().toLower().remove(numberSuffix);
+    return labels.contains(stem) ? stem : QString();
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("quickdraw-score");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("以遊戲的模型批次辨識資料夾中的圖片");
+    parser.addHelpOption();
+    parser.addPositionalArgument("paths", "圖片資料夾或檔案", "paths...");
+    parser.addOption({"model", "TFLite 模型", "file", "model_unquant.tflite"});
+    parser.addOption({"labels", "標籤檔", "file", "labels.txt"});
+    parser.addOption({"workers", "平行的 worker 數（各自載入一份模型）", "count",
+                      QString::number(QThread::idealThreadCount())});
+    parser.addOption({"intra-threads", "每個 worker 的 TFLite 執行緒數", "count", "1"});
+    parser.addOption({"xnnpack", "使用 XNNPACK delegate"});
+    parser.addOption({"batch", "每次推理的張數", "count", "8"});
+    parser.addOption({"top", "每筆紀錄列出的候選類別數", "count", "3"});
+    parser.addOption({"format", "jsonl 或 csv", "format", "jsonl"});
+    parser.addOption({"output", "輸出檔（預設輸出到 stdout）", "file"});
+    parser.addOption({"progress-ms", "進度回報間隔（0 = 不回報）", "ms", "2000"});
+    parser.process(app);
+
+    const QStringList roots = parser.positionalArguments();
+    if (roots.isEmpty()) {
+        parser.showHelp(1);
+    }
+    const int workers = qMax(1, parser.value("workers").toInt());
+    const int batch = qMax(1, parser.value("batch").toInt());
+    const int topCount = qMax(0, parser.value("top").toInt());
+    const bool csv = parser.value("format") == "csv";
+
+    QString labelsError;
+    const QStringList labels = InferenceEngine::loadLabels(parser.value("labels"), &labelsError);
+    if (labels.isEmpty()) {
+        qCritical().noquote() << labelsError;
+        return 1;
+    }
+    const QSet<QString> labelSet(labels.begin(), labels.end());
+
+    const QStringList paths = collectImages(roots);
+    if (paths.isEmpty()) {
+        qCritical().noquote() << "找不到圖片：" + roots.join(' ');
+        return 1;
+    }
+
+    QFile output;
+    const bool opened = parser.isSet("output")
+                            ? (output.setFileName(parser.value("output")), output.open(QIODevice::WriteOnly))
+                            : output.open(stdout, QIODevice::WriteOnly);
+    if (!opened) {
+        qCritical().noquote() << "無法寫入 " + parser.value("output");
+        return 1;
+    }
+    qInfo().noquote() << QString("%1 張圖片，%2 個 worker，批次 %3").arg(paths.size()).arg(workers).arg(batch);
+
+    RecordSink sink(&output, csv, paths.size(), parser.value("progress-ms").toInt(), labels);
+    std::atomic<int> next{0};
+    std::atomic<bool> failed{false};
+    QMutex errorMutex;
+    QString loadError;
+
+    InferenceEngine::Options engineOptions;
+    engineOptions.numThreads = qMax(1, parser.value("intra-threads").toInt());
+    engineOptions.xnnpack = parser.isSet("xnnpack");
+    const QString modelPath = parser.value("model");
+    const QString labelsPath = parser.value("labels");
+
+    // 每個 worker 一份模型，以原子計數器領取下一批圖片，讀檔解碼也在 worker 中平行進行
+    const auto work = [&]() {
+        InferenceEngine engine;
+        if (!engine.load(modelPath, labelsPath, engineOptions)) {
+            QMutexLocker locker(&errorMutex);
+            loadError = engine.errorString();
+            failed = true;
+            return;
+        }
+        QElapsedTimer timer;
+        while (!failed) {
+            const int first = next.fetch_add(batch);
+            if (first >= paths.size()) {
+                break;
+            }
+            const int last = qMin<int>(first + batch, paths.size());
+
+            QVector<Record> records;
+            QVector<QImage> images;
+            QVector<int> decoded;   // records 中成功解碼者的索引
+            for (int i = first; i < last; ++i) {
+                Record record;
+                record.path = paths[i];
+                record.expected = expectedLabel(record.path, labelSet);
+                timer.start();
+                const QImage image(record.path);
+                record.decodeMs = timer.nsecsElapsed() / 1e6;
+                if (image.isNull()) {
+                    record.error = "無法讀取圖片";
+                } else {
+                    images.append(image);
+                    decoded.append(records.size());
+                }
+                records.append(record);
+            }
+
+            if (!images.isEmpty()) {
+                timer.start();
+                const QVector<Prediction> predictions = engine.classifyBatch(images);
+                const double perImageMs = timer.nsecsElapsed() / 1e6 / images.size();
+                for (int i = 0; i < decoded.size(); ++i) {
+                    Record &record = records[decoded[i]];
+                    if (i >= predictions.size()) {
+                        record.error = engine.errorString();
+                        continue;
+                    }
+                    record.prediction = predictions[i];
+                    record.top = InferenceEngine::topK(record.prediction.scores, topCount);
+                    record.inferMs = perImageMs;
+                }
+            }
+            sink.write(records);
+        }
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+    QList<QFuture<void>> tasks;
+    for (int i = 0; i < workers; ++i) {
+        tasks.append(QtConcurrent::run(&pool, work));
+    }
+    for (QFuture<void> &task : tasks) {
+        task.waitForFinished();
+    }
+
+    if (failed) {
+        qCritical().noquote() << "模型載入失敗：" + loadError;
+        return 2;
+    }
+
+    const QJsonObject summary = sink.summary();
+    qInfo().noquote() << QString("完成：%1 張，%2 秒，%3 img/s，準確率 %4%（%5 張可判斷）")
+                             .arg(summary["images"].toInt()).arg(summary["elapsedSec"].toDouble(), 0, 'f', 1)
+                             .arg(summary["imagesPerSec"].toDouble(), 0, 'f', 1)
+                             .arg(summary["accuracy"].toDouble() * 100, 0, 'f', 1).arg(summary["scored"].toInt());
+    qInfo().noquote() << QJsonDocument(summary).toJson(QJsonDocument::Compact);
+    return summary["errors"].toInt() > 0 ? 3 : 0;
+}
@@ -0,0 +1,18 @@
+# 批次評分：以與遊戲相同的前處理與模型，平行辨識整個資料夾的圖片
+# 需以 TFLite 編譯：qmake "TFLITE_DIR=C:/libs/tflite" score.pro
+
+QT += core gui concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = quickdraw-score
+
+SOURCES += \
+    main.cpp \
+    $$PWD/../../latencystats.cpp
+
+HEADERS += \
+    $$PWD/../../latencystats.h
+
+include(../../inference.pri)
@@ -0,0 +1,8 @@
+# 命令列工具
+# 建置方式：qmake "TFLITE_DIR=C:/libs/tflite" tools.pro && make
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    score \
+    watch
@@ -0,0 +1,247 @@
+﻿// 常駐辨識端
+//
+// 取代 cv/watch_images.py + lite.py：模型只在啟動時載入一次，
+// 以 inotify（IN_CLOSE_WRITE / IN_MOVED_TO）只處理已寫完的圖片，
+// 放進有上限的工作佇列，由多個 worker 平行辨識，連續湧入的圖片不會被序列化或漏掉。
+// 結果以與 lite.py 相同的格式追加到 result.txt，圖片移到 resultfile/，遊戲端不需修改。
+//
+// 佇列滿時圖片留在資料夾中，等有 worker 空下來再重新掃描補上，記憶體用量不隨積壓增加。
+//
+// 用法：
+//   ./quickdraw-watch [--images dir] [--results dir] [--result-file result.txt]
+//       [--model model_unquant.tflite] [--labels labels.txt]
+//       [--workers 2] [--intra-threads 1] [--xnnpack] [--queue 16]
+// 預設路徑取自 quickdraw.ini（與遊戲相同的 AppConfig）
+
+#include "appconfig.h"
+#include "imagefolderwatcher.h"
+#include "inferenceengine.h"
+#include "latencystats.h"
+#include "tracer.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QQueue>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
+#include <memory>
+#include <vector>
+
+struct Job {
+    QString path;
+    qint64 detectedMicros = 0;
+};
+
+// 有上限的工作佇列：監視端 tryPush 不會阻塞，worker 在 pop 中等待
+class WorkQueue {
+public:
+    explicit WorkQueue(int capacity) : capacity(capacity) {}
+
+    bool tryPush(const Job &job) {
+        QMutexLocker locker(&mutex);
+        if (closed || jobs.size() >= capacity) {
+            return false;
+        }
+        jobs.enqueue(job);
+        notEmpty.wakeOne();
+        return true;
+    }
+
+    bool pop(Job *job) {
+        QMutexLocker locker(&mutex);
+        while (jobs.isEmpty() && !closed) {
+            notEmpty.wait(&mutex);
+        }
+        if (jobs.isEmpty()) {
+            return false;
+        }
+        *job = jobs.dequeue();
+        return true;
+    }
+
+    void close() {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        notEmpty.wakeAll();
+    }
+
+    int size() const {
+        QMutexLocker locker(&mutex);
+        return int(jobs.size());
+    }
+
+private:
+    const int capacity;
+    mutable QMutex mutex;
+    QWaitCondition notEmpty;
+    QQueue<Job> jobs;
+    bool closed = false;
+};
+
+// 追加結果與移動圖片，多個 worker 共用
+class ResultWriter {
+public:
+    ResultWriter(const QString &resultFile, const QString &resultFolder)
+        : resultFile(resultFile), resultFolder(resultFolder) {}
+
+    void write(const QString &imagePath, const Prediction &prediction, qint64 detectedMicros) {
+        const QFileInfo info(imagePath);
+        const bool correct = info.completeBaseName().trimmed().toLower() == prediction.label;
+        // 檔名可能含有 %，不用 arg() 串接以免被當成佔位符
+        const QString line = "Image: " + info.fileName()
+                             + " | Predicted Class: " + prediction.label
+                             + " | Confidence: " + QString::number(prediction.confidence, 'f', 2)
+                             + " | Result: " + (correct ? "yes" : "no")
+                             + " | Detected: " + QString::number(detectedMicros)
+                             + " | InferStart: " + QString::number(prediction.startedMicros)
+                             + " | InferEnd: " + QString::number(prediction.finishedMicros) + "\n";
+
+        QMutexLocker locker(&mutex);
+        QFile file(resultFile);
+        if (!file.open(QIODevice::Append | QIODevice::Text) || file.write(line.toUtf8()) < 0) {
+            qWarning().noquote() << "無法寫入 " + resultFile;
+        }
+        file.close();
+        moveToResults(imagePath);
+        qInfo().noquote() << info.fileName() + " → " + prediction.label
+                                 + QString(" (%1, %2)").arg(correct ? "yes" : "no").arg(prediction.confidence, 0, 'f', 2);
+    }
+
+    // 與 lite.py 的 shutil.move 相同：同名檔案直接覆蓋
+    void moveToResults(const QString &imagePath) {
+        const QString target = resultFolder + "/" + QFileInfo(imagePath).fileName();
+        QFile::remove(target);
+        if (!QFile::rename(imagePath, target)) {
+            qWarning().noquote() << "無法移動 " + imagePath;
+        }
+    }
+
+private:
+    QString resultFile;
+    QString resultFolder;
+    QMutex mutex;
+};
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("quickdraw-watch");
+    const AppConfig config = AppConfig::load();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("監視圖片資料夾並以常駐模型辨識");
+    parser.addHelpOption();
+    parser.addOption({"images", "監視的圖片資料夾", "dir", config.imageFolderPath()});
+    parser.addOption({"results", "辨識後圖片移到此資料夾", "dir", config.resultFolderPath()});
+    parser.addOption({"result-file", "追加結果的檔案", "file", config.resultFilePath()});
+    parser.addOption({"model", "TFLite 模型", "file", config.modelPath});
+    parser.addOption({"labels", "標籤檔", "file", config.labelsPath});
+    parser.addOption({"workers", "平行辨識的 worker 數（各自載入一份模型）", "count", "2"});
+    parser.addOption({"intra-threads", "每個 worker 的 TFLite 執行緒數", "count", "1"});
+    parser.addOption({"xnnpack", "使用 XNNPACK delegate"});
+    parser.addOption({"queue", "工作佇列上限", "count", "16"});
+    parser.process(app);
+
+    const int workers = qMax(1, parser.value("workers").toInt());
+    InferenceEngine::Options engineOptions;
+    engineOptions.numThreads = qMax(1, parser.value("intra-threads").toInt());
+    engineOptions.xnnpack = parser.isSet("xnnpack");
+
+    // 模型在開始監視前全部載入，第一張圖不必等待載入
+    QElapsedTimer loadClock;
+    loadClock.start();
+    std::vector<std::unique_ptr<InferenceEngine>> engines;
+    for (int i = 0; i < workers; ++i) {
+        auto engine = std::make_unique<InferenceEngine>();
+        if (!engine->load(parser.value("model"), parser.value("labels"), engineOptions)) {
+            qCritical().noquote() << "模型載入失敗：" + engine->errorString();
+            return 2;
+        }
+        QImage blank(InferenceEngine::InputSize, InferenceEngine::InputSize, QImage::Format_RGB32);
+        blank.fill(Qt::white);   // 與主程式相同以空白畫布暖機，不餵未初始化的像素
+        engine->classify(blank);
+        engines.push_back(std::move(engine));
+    }
+    qInfo().noquote() << QString("已載入 %1 份模型（%2 ms）").arg(workers).arg(loadClock.elapsed());
+
+    const QString resultFolder = parser.value("results");
+    QDir().mkpath(resultFolder);
+    ResultWriter writer(parser.value("result-file"), resultFolder);
+    WorkQueue queue(qMax(1, parser.value("queue").toInt()));
+    ImageFolderWatcher watcher;
+    bool backlogged = false;   // 有圖片因佇列滿而留在資料夾中
+
+    // 完成一張後回到主執行緒：解除檔名的記錄，必要時重新掃描補上積壓的圖片
+    const auto finished = [&](const QString &path) {
+        watcher.forget(path);
+        if (backlogged) {
+            backlogged = false;
+            watcher.rescan();
+        }
+    };
+
+    const auto work = [&](InferenceEngine *engine) {
+        Job job;
+        while (queue.pop(&job)) {
+            QImage image(job.path);
+            const quint64 submissionId = image.text("SubmissionId").toULongLong();
+            if (submissionId != 0) {
+                Tracer::instance().flowEnd(submissionId, job.detectedMicros);   // 不是遊戲送來的圖片就沒有對應的起點
+            }
+            if (image.isNull()) {
+                qWarning().noquote() << "無法讀取圖片，移到結果資料夾：" + job.path;
+                writer.moveToResults(job.path);
+            } else {
+                Prediction prediction;
+                {
+                    TraceSpan span("classify", submissionId);
+                    const qint64 started = SubmissionLatency::nowMicros();
+                    prediction = engine->classify(image);
+                    prediction.startedMicros = started;
+                    prediction.finishedMicros = SubmissionLatency::nowMicros();
+                }
+                if (prediction.isValid()) {
+                    writer.write(job.path, prediction, job.detectedMicros);
+                } else {
+                    qWarning().noquote() << "辨識失敗：" + engine->errorString();
+                    writer.moveToResults(job.path);
+                }
+            }
+            Tracer::instance().flush();
+            QMetaObject::invokeMethod(&app, [&finished, path = job.path]() { finished(path); });
+        }
+    };
+
+    QObject::connect(&watcher, &ImageFolderWatcher::fileReady, &app, [&](const QString &path, qint64 detectedMicros) {
+        if (!queue.tryPush({path, detectedMicros})) {
+            watcher.forget(path);   // 留在磁碟上，之後重新掃描時再送出
+            backlogged = true;
+        }
+    });
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+    QList<QFuture<void>> tasks;
+    for (const auto &engine : engines) {
+        tasks.append(QtConcurrent::run(&pool, work, engine.get()));
+    }
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &app, [&]() {
+        queue.close();
+        for (QFuture<void> &task : tasks) {
+            task.waitForFinished();
+        }
+    });
+
+    if (!watcher.start(parser.value("images"))) {
+        qCritical().noquote() << watcher.errorString();
+        queue.close();
+        return 1;
+    }
+    qInfo().noquote() << QString("開始監視 %1（%2，%3 個 worker）")
+                             .arg(parser.value("images"), watcher.backendName()).arg(workers);
+    return app.exec();
+}
@@ -0,0 +1,24 @@
+# 常駐辨識端：取代 cv/watch_images.py + lite.py
+# 需以 TFLite 編譯：qmake "TFLITE_DIR=C:/libs/tflite" watch.pro
+
+QT += core gui concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = quickdraw-watch
+
+SOURCES += \
+    main.cpp \
+    $$PWD/../../appconfig.cpp \
+    $$PWD/../../imagefolderwatcher.cpp \
+    $$PWD/../../latencystats.cpp \
+    $$PWD/../../tracer.cpp
+
+HEADERS += \
+    $$PWD/../../appconfig.h \
+    $$PWD/../../imagefolderwatcher.h \
+    $$PWD/../../latencystats.h \
+    $$PWD/../../tracer.h
+
+include(../../inference.pri)
@@ -0,0 +1,121 @@
+﻿#include "tracer.h"
+#include "latencystats.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QThread>
+#include <atomic>
+
+namespace {
+constexpr int FlushThreshold = 64 * 1024;
+
+qint64 currentThreadNumber() {
+    return qint64(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+}
+}
+
+Tracer &Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() {
+    const QString directory = qEnvironmentVariable("QUICKDRAW_TRACE_DIR");
+    if (directory.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(directory);
+    pid = QCoreApplication::applicationPid();
+    file.setFileName(QString("%1/qt-%2.trace.json").arg(directory).arg(pid));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning().noquote() << "無法建立追蹤檔：" + file.fileName();
+        return;
+    }
+    enabled = true;
+
+    // JSON Array 格式：開頭的 [ 之後每行一個事件，結尾的 ] 可省略
+    buffer = "[\n";
+    append(QString(R"({"name":"process_name","ph":"M","pid":%1,"args":{"name":"%2"}})")
+               .arg(pid).arg(QCoreApplication::applicationName()).toUtf8());
+}
+
+Tracer::~Tracer() {
+    flush();
+}
+
+void Tracer::complete(const char *name, qint64 startMicros, qint64 durationMicros, quint64 submissionId) {
+    if (!enabled) {
+        return;
+    }
+    QByteArray event = QString(R"({"name":"%1","cat":"qt","ph":"X","ts":%2,"dur":%3,"pid":%4,"tid":%5)")
+                           .arg(QLatin1String(name)).arg(startMicros).arg(durationMicros)
+                           .arg(pid).arg(currentThreadNumber()).toUtf8();
+    if (submissionId != 0) {
+        event += QString(R"(,"args":{"submission":%1})").arg(submissionId).toUtf8();
+    }
+    event += '}';
+    append(event);
+}
+
+void Tracer::flowStart(quint64 submissionId, qint64 timestampMicros) {
+    if (!enabled) {
+        return;
+    }
+    append(QString(R"({"name":"submission","cat":"submission","ph":"s","id":%1,"ts":%2,"pid":%3,"tid":%4})")
+               .arg(submissionId).arg(timestampMicros).arg(pid).arg(currentThreadNumber()).toUtf8());
+}
+
+void Tracer::flowEnd(quint64 submissionId, qint64 timestampMicros) {
+    if (!enabled) {
+        return;
+    }
+    append(QString(R"({"name":"submission","cat":"submission","ph":"f","bp":"e","id":%1,"ts":%2,"pid":%3,"tid":%4})")
+               .arg(submissionId).arg(timestampMicros).arg(pid).arg(currentThreadNumber()).toUtf8());
+}
+
+void Tracer::counter(const char *name, qint64 timestampMicros, qint64 value) {
+    if (!enabled) {
+        return;
+    }
+    append(QString(R"({"name":"%1","ph":"C","ts":%2,"pid":%3,"args":{"value":%4}})")
+               .arg(QLatin1String(name)).arg(timestampMicros).arg(pid).arg(value).toUtf8());
+}
+
+void Tracer::flush() {
+    if (!enabled) {
+        return;
+    }
+    QMutexLocker locker(&mutex);
+    file.write(buffer);
+    file.flush();
+    buffer.clear();
+}
+
+// 每秒不會超過 1000 次提交，以毫秒時間戳乘 1000 再加序號即可保持唯一（且小於 2^53，JSON 數字不失真）
+quint64 Tracer::newSubmissionId() {
+    static std::atomic<quint32> counter{0};
+    return quint64(QDateTime::currentMSecsSinceEpoch()) * 1000 + (counter.fetch_add(1) % 1000);
+}
+
+void Tracer::append(const QByteArray &event) {
+    QMutexLocker locker(&mutex);
+    buffer += event;
+    buffer += ",\n";
+    if (buffer.size() >= FlushThreshold) {
+        file.write(buffer);
+        buffer.clear();
+    }
+}
+
+TraceSpan::TraceSpan(const char *name, quint64 submissionId)
+    : name(name), submissionId(submissionId) {
+    if (Tracer::instance().isEnabled()) {
+        startMicros = SubmissionLatency::nowMicros();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (startMicros != 0) {
+        Tracer::instance().complete(name, startMicros, SubmissionLatency::nowMicros() - startMicros, submissionId);
+    }
+}
@@ -0,0 +1,58 @@
+﻿#ifndef TRACER_H
+#define TRACER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QtGlobal>
+
+// Chrome trace-event 格式的輕量追蹤
+// 設定環境變數 QUICKDRAW_TRACE_DIR 後寫入 <dir>/qt-<pid>.trace.json；未設定時各呼叫只做一次判斷
+// 時間戳為 epoch 微秒，與 cv/tracing.py 相同，兩邊的檔案可用 cv/merge_traces.py 合併後在 Perfetto 開啟
+class Tracer {
+public:
+    static Tracer &instance();
+
+    bool isEnabled() const { return enabled; }
+
+    // 完整區段（ph = X）；submissionId 非 0 時寫入 args，方便跨程序對照
+    void complete(const char *name, qint64 startMicros, qint64 durationMicros, quint64 submissionId = 0);
+    // 提交流程的起點（ph = s），Python 端以相同 id 寫入終點
+    void flowStart(quint64 submissionId, qint64 timestampMicros);
+    // 提交流程的終點（ph = f），由取代 Python 端的 quickdraw-watch 寫入
+    void flowEnd(quint64 submissionId, qint64 timestampMicros);
+    // 計數器（ph = C），例如辨識伺服器的佇列深度與批次大小
+    void counter(const char *name, qint64 timestampMicros, qint64 value);
+    void flush();
+
+    static quint64 newSubmissionId();
+
+private:
+    Tracer();
+    ~Tracer();
+    Q_DISABLE_COPY(Tracer)
+
+    void append(const QByteArray &event);
+
+    bool enabled = false;
+    qint64 pid = 0;
+    QFile file;
+    QByteArray buffer;
+    QMutex mutex;
+};
+
+// 以 RAII 記錄一段區間
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, quint64 submissionId = 0);
+    ~TraceSpan();
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char *name;
+    quint64 submissionId;
+    qint64 startMicros = 0;
+};
+
+#endif // TRACER_H
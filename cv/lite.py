@@ -1,8 +1,14 @@
+import time
+
+# 記錄腳本啟動時間（epoch 微秒），用來區分 Python 啟動與模型載入的耗時
+script_start_us = time.time_ns() // 1000
+
 import numpy as np
 import tensorflow as tf
 from PIL import Image, ImageOps
 import os
 import shutil  # 用於移動檔案
+import tracing
 
 # 禁用科學記號
 np.set_printoptions(suppress=True)
@@ -15,29 +21,35 @@ interpreter.allocate_tensors()
 input_details = interpreter.get_input_details()
 output_details = interpreter.get_output_details()
 
+# 啟動到模型可用（含 import tensorflow）記為一段
+tracing.complete("model_load", script_start_us, tracing.now_us() - script_start_us)
+
 # 單張圖片辨識
-def predict_image(image_path):
-    # 載入圖片並轉換為 RGB
-    image = Image.open(image_path).convert("RGB")
+def predict_image(image_path, submission=None):
+    with tracing.span("preprocess", submission):
+        # 載入圖片並轉換為 RGB
+        image = Image.open(image_path).convert("RGB")
 
-    # 調整大小並裁剪
-    size = (224, 224)
-    image = ImageOps.fit(image, size, Image.Resampling.LANCZOS)
+        # 調整大小並裁剪
+        size = (224, 224)
+        image = ImageOps.fit(image, size, Image.Resampling.LANCZOS)
 
-    # 正規化圖片數據
-    image_array = np.asarray(image).astype(np.float32) / 127.5 - 1
-    image_array = np.expand_dims(image_array, axis=0)
+        # 正規化圖片數據
+        image_array = np.asarray(image).astype(np.float32) / 127.5 - 1
+        image_array = np.expand_dims(image_array, axis=0)
 
-    # 設定模型輸入
-    interpreter.set_tensor(input_details[0]['index'], image_array)
+        # 設定模型輸入
+        interpreter.set_tensor(input_details[0]['index'], image_array)
 
     # 運行推理
-    interpreter.invoke()
+    with tracing.span("invoke", submission):
+        interpreter.invoke()
 
     # 獲取模型輸出
-    output_data = interpreter.get_tensor(output_details[0]['index'])
-    index = np.argmax(output_data)
-    confidence_score = output_data[0][index]
+    with tracing.span("postprocess", submission):
+        output_data = interpreter.get_tensor(output_details[0]['index'])
+        index = np.argmax(output_data)
+        confidence_score = output_data[0][index]
 
     return index, confidence_score
 
@@ -58,8 +70,14 @@ def process_single_image(folder_path, class_names_file, result_file, result_fold
     image_file = image_files[0]
     image_path = os.path.join(folder_path, image_file)
 
+    # 取得 Qt 寫在 PNG 裡的提交編號，讓兩邊的追蹤紀錄能對應
+    submission = tracing.read_submission_id(image_path) if tracing.enabled() else None
+    tracing.flow_end(submission, tracing.now_us())
+
     # 辨識圖片
-    index, confidence_score = predict_image(image_path)
+    infer_start_us = time.time_ns() // 1000
+    index, confidence_score = predict_image(image_path, submission)
+    infer_end_us = time.time_ns() // 1000
     class_name = class_names[index]  # 模型預測的類別
 
     # 比較檔名與辨識結果
@@ -67,9 +85,15 @@ def process_single_image(folder_path, class_names_file, result_file, result_fold
     print(f"檔名: {file_name_without_extension}, 預測類別: {class_name}")  # 調試輸出
     result = "yes" if file_name_without_extension == class_name else "no"
 
+    # 各階段時間戳附在結果後面，供主程式統計延遲（Detected 由 watch_images.py 傳入）
+    timings = f" | ScriptStart: {script_start_us} | InferStart: {infer_start_us} | InferEnd: {infer_end_us}"
+    detected_us = os.environ.get("QUICKDRAW_DETECTED_US")
+    if detected_us:
+        timings = f" | Detected: {detected_us}" + timings
+
     # 將結果追加寫入 result.txt
-    with open(result_file, "a") as f:  # 使用 'a' 模式以追加內容
-        f.write(f"Image: {image_file} | Predicted Class: {class_name} | Confidence: {confidence_score:.2f} | Result: {result}\n")
+    with tracing.span("write_result", submission), open(result_file, "a") as f:  # 使用 'a' 模式以追加內容
+        f.write(f"Image: {image_file} | Predicted Class: {class_name} | Confidence: {confidence_score:.2f} | Result: {result}{timings}\n")
     print(f"結果已追加到 {result_file}：{result}")
 
     # 移動圖片到 result_folder
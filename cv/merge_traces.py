@@ -0,0 +1,36 @@
+import json
+import sys
+
+# 合併 Qt 端（qt-<pid>.trace.json）與 Python 端（python.trace.json）的追蹤檔
+# 輸出標準的 {"traceEvents": [...]}，可直接在 https://ui.perfetto.dev 開啟
+#
+# 用法：python merge_traces.py 輸出.json 追蹤檔1 [追蹤檔2 ...]
+
+
+def read_events(path):
+    events = []
+    with open(path, "r", encoding="utf-8") as f:
+        for line in f:
+            line = line.strip().rstrip(",")
+            if not line or line in ("[", "]"):
+                continue
+            try:
+                events.append(json.loads(line))
+            except json.JSONDecodeError:
+                pass  # 程式中斷時最後一行可能不完整
+    return events
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("用法：python merge_traces.py 輸出.json 追蹤檔1 [追蹤檔2 ...]")
+        sys.exit(1)
+
+    merged = []
+    for path in sys.argv[2:]:
+        merged.extend(read_events(path))
+    merged.sort(key=lambda event: event.get("ts", 0))
+
+    with open(sys.argv[1], "w", encoding="utf-8") as f:
+        json.dump({"traceEvents": merged, "displayTimeUnit": "ms"}, f, ensure_ascii=False)
+    print(f"已合併 {len(merged)} 個事件到 {sys.argv[1]}")
@@ -0,0 +1,92 @@
+import json
+import os
+import sys
+import threading
+import time
+from contextlib import contextmanager
+
+# Chrome trace-event 追蹤（與 Qt 端 tracer.cpp 相同格式）
+# 設定環境變數 QUICKDRAW_TRACE_DIR 後，所有 Python 程序都追加到 <dir>/python.trace.json
+# 時間戳為 epoch 微秒；用 merge_traces.py 與 Qt 端的檔案合併後即可在 Perfetto 中看到同一條時間線
+
+_trace_dir = os.environ.get("QUICKDRAW_TRACE_DIR")
+_lock = threading.Lock()
+_pid = os.getpid()
+_file = None
+
+
+def now_us():
+    return time.time_ns() // 1000
+
+
+def enabled():
+    return bool(_trace_dir)
+
+
+def _write(event):
+    global _file
+    if not _trace_dir:
+        return
+    line = json.dumps(event, ensure_ascii=False) + ",\n"
+    with _lock:
+        if _file is None:
+            os.makedirs(_trace_dir, exist_ok=True)
+            path = os.path.join(_trace_dir, "python.trace.json")
+            # 由第一個建立檔案的程序寫入開頭的 [
+            try:
+                fd = os.open(path, os.O_WRONLY | os.O_CREAT | os.O_EXCL | os.O_APPEND)
+                os.write(fd, b"[\n")
+            except FileExistsError:
+                fd = os.open(path, os.O_WRONLY | os.O_APPEND)
+            _file = fd
+            process_name = os.path.basename(sys.argv[0]) or "python"
+            os.write(_file, (json.dumps({"name": "process_name", "ph": "M", "pid": _pid,
+                                         "args": {"name": process_name}}) + ",\n").encode("utf-8"))
+        # 以 O_APPEND 一次寫入整行，多個程序同時追加也不會交錯
+        os.write(_file, line.encode("utf-8"))
+
+
+def complete(name, start_us, duration_us, submission=None):
+    event = {"name": name, "cat": "python", "ph": "X", "ts": start_us, "dur": duration_us,
+             "pid": _pid, "tid": threading.get_ident()}
+    if submission:
+        event["args"] = {"submission": submission}
+    _write(event)
+
+
+def flow_end(submission, timestamp_us):
+    # 與 Qt 端 flowStart 的 id 相同，Perfetto 會畫出跨程序的箭頭
+    if submission:
+        _write({"name": "submission", "cat": "submission", "ph": "f", "bp": "e", "id": submission,
+                "ts": timestamp_us, "pid": _pid, "tid": threading.get_ident()})
+
+
+@contextmanager
+def span(name, submission=None):
+    if not _trace_dir:
+        yield
+        return
+    start = now_us()
+    try:
+        yield
+    finally:
+        complete(name, start, now_us() - start, submission)
+
+
+def read_submission_id(image_path):
+    # Qt 把提交編號寫在 PNG 的 tEXt 區塊（位於影像資料之前），只需讀檔頭
+    try:
+        with open(image_path, "rb") as f:
+            head = f.read(4096)
+    except OSError:
+        return None
+    key = b"SubmissionId\x00"
+    pos = head.find(key)
+    if pos < 0:
+        return None
+    digits = bytearray()
+    for byte in head[pos + len(key):]:
+        if not chr(byte).isdigit():
+            break
+        digits.append(byte)
+    return int(digits) if digits else None
@@ -1,47 +1,54 @@
-import time
-import os
-from watchdog.observers import Observer
-from watchdog.events import FileSystemEventHandler
-import subprocess
-
-class ImageEventHandler(FileSystemEventHandler):
-    def __init__(self, images_folder, script_path, python_path):
-        self.images_folder = images_folder
-        self.script_path = script_path
-        self.python_path = python_path
-
-    def on_created(self, event):
-        # 只處理圖片檔案
-        if event.src_path.lower().endswith(('.png', '.jpg', '.jpeg')):
-            print(f"新圖片檔案檢測到: {event.src_path}")
-            self.process_image()
-
-    def process_image(self):
-        # 執行辨識程式
-        print("執行辨識程式...")
-        subprocess.run([self.python_path, self.script_path], check=True)
-
-def monitor_images_folder(images_folder, script_path, python_path):
-    # 初始化監視器
-    event_handler = ImageEventHandler(images_folder, script_path, python_path)
-    observer = Observer()
-    observer.schedule(event_handler, images_folder, recursive=False)
-
-    # 開始監視
-    print(f"開始監視資料夾: {images_folder}")
-    observer.start()
-
-    try:
-        while True:
-            time.sleep(1)  # 保持程式運行
-    except KeyboardInterrupt:
-        observer.stop()
-        print("監視已停止。")
-
-    observer.join()
-
-if __name__ == "__main__":
-    images_folder = "images"  # 資料夾路徑
-    script_path = "lite.py"  # 辨識程式的路徑
-    python_path = os.path.join("venv", "Scripts", "python")  # 虛擬環境中的 Python 解釋器路徑
-    monitor_images_folder(images_folder, script_path, python_path)
+# 舊的監視流程：每張圖片都重新啟動 lite.py 並同步等待，連續送來的圖片會被序列化
+# 建議改用 QTFinalReport/tools/watch 的 quickdraw-watch（常駐模型、只處理寫完的檔案、平行辨識）
+import time
+import os
+from watchdog.observers import Observer
+from watchdog.events import FileSystemEventHandler
+import subprocess
+import tracing
+
+class ImageEventHandler(FileSystemEventHandler):
+    def __init__(self, images_folder, script_path, python_path):
+        self.images_folder = images_folder
+        self.script_path = script_path
+        self.python_path = python_path
+
+    def on_created(self, event):
+        # 只處理圖片檔案
+        if event.src_path.lower().endswith(('.png', '.jpg', '.jpeg')):
+            detected_us = time.time_ns() // 1000  # 偵測到檔案的時間（epoch 微秒）
+            print(f"新圖片檔案檢測到: {event.src_path}")
+            self.process_image(event.src_path, detected_us)
+
+    def process_image(self, image_path, detected_us):
+        # 執行辨識程式，並把偵測時間傳給 lite.py 寫進結果
+        print("執行辨識程式...")
+        env = dict(os.environ, QUICKDRAW_DETECTED_US=str(detected_us))
+        submission = tracing.read_submission_id(image_path) if tracing.enabled() else None
+        with tracing.span("watcher_dispatch", submission):
+            subprocess.run([self.python_path, self.script_path], check=True, env=env)
+
+def monitor_images_folder(images_folder, script_path, python_path):
+    # 初始化監視器
+    event_handler = ImageEventHandler(images_folder, script_path, python_path)
+    observer = Observer()
+    observer.schedule(event_handler, images_folder, recursive=False)
+
+    # 開始監視
+    print(f"開始監視資料夾: {images_folder}")
+    observer.start()
+
+    try:
+        while True:
+            time.sleep(1)  # 保持程式運行
+    except KeyboardInterrupt:
+        observer.stop()
+        print("監視已停止。")
+
+    observer.join()
+
+if __name__ == "__main__":
+    images_folder = "images"  # 資料夾路徑
+    script_path = "lite.py"  # 辨識程式的路徑
+    python_path = os.path.join("venv", "Scripts", "python")  # 虛擬環境中的 Python 解釋器路徑
+    monitor_images_folder(images_folder, script_path, python_path)